@@ -0,0 +1,184 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/** Performs file system operations on a background thread so that the caller never waits for the disk.
+ *  Jobs are executed in submission order, in batches: every job queued while the disk is busy is
+ *  handled in the next batch. Consecutive pending writes to the same file are coalesced, only the last data is written.
+ *  Files are first written to a temporary file and then renamed to ensure that a crash
+ *  during the write never leaves a truncated file behind.
+ */
+class AsyncWriter
+{
+public:
+    AsyncWriter()
+        : m_thread{[this]() { run(); }}
+    {}
+
+    ~AsyncWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_running = false;
+        }
+        m_condition.notify_one();
+        m_thread.join();
+    }
+
+    AsyncWriter(AsyncWriter const&) = delete;
+    AsyncWriter& operator=(AsyncWriter const&) = delete;
+
+    /// Queues the data to be written in the file, replacing its content
+    void write(std::string const& filename, std::vector<char>&& data)
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            // If the last pending job on this file is a write, just replace its data.
+            // Appends queued after a write have to run before the new one, which is then queued at the end
+            for (auto it = m_jobs.rbegin(); it != m_jobs.rend(); ++it) {
+                if (it->filename != filename) {
+                    continue;
+                }
+                if (it->type == JobType::Write) {
+                    it->data = std::move(data);
+                    return;
+                }
+                break;
+            }
+            m_jobs.push_back({JobType::Write, filename, std::move(data)});
+        }
+        m_condition.notify_one();
+    }
+
+    /// Queues the data to be appended at the end of the file
+    void append(std::string const& filename, std::vector<char>&& data)
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_jobs.push_back({JobType::Append, filename, std::move(data)});
+        }
+        m_condition.notify_one();
+    }
+
+    /// Queues the creation of the directory and its parents, jobs queued after can safely write in it
+    void createDirectories(std::string const& path)
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_jobs.push_back({JobType::CreateDirectories, path, {}});
+        }
+        m_condition.notify_one();
+    }
+
+    /// Blocks until all the queued jobs are executed
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_idle_condition.wait(lock, [this]() { return m_jobs.empty() && !m_busy; });
+    }
+
+private:
+    enum class JobType : uint8_t
+    {
+        Write,
+        Append,
+        CreateDirectories,
+    };
+
+    struct Job
+    {
+        JobType           type = JobType::Write;
+        std::string       filename;
+        std::vector<char> data;
+    };
+
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+    std::condition_variable m_idle_condition;
+    std::deque<Job>         m_jobs;
+    bool                    m_running = true;
+    bool                    m_busy    = false;
+    std::thread             m_thread;
+
+    void run()
+    {
+        std::deque<Job> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock{m_mutex};
+                m_condition.wait(lock, [this]() { return !m_jobs.empty() || !m_running; });
+                if (m_jobs.empty()) {
+                    // Only exit once every job has been executed
+                    return;
+                }
+                std::swap(batch, m_jobs);
+                m_busy = true;
+            }
+
+            executeBatch(batch);
+            batch.clear();
+
+            {
+                std::lock_guard<std::mutex> lock{m_mutex};
+                m_busy = false;
+            }
+            m_idle_condition.notify_all();
+        }
+    }
+
+    static void executeBatch(std::deque<Job> const& batch)
+    {
+        auto const count = batch.size();
+        for (size_t i{0}; i < count;) {
+            Job const& job = batch[i];
+            if (job.type == JobType::Append) {
+                // Consecutive appends to the same file share the same stream
+                std::ofstream outfile{job.filename, std::ios::out | std::ios::binary | std::ios::app};
+                for (; i < count && batch[i].type == JobType::Append && batch[i].filename == job.filename; ++i) {
+                    outfile.write(batch[i].data.data(), static_cast<std::streamsize>(batch[i].data.size()));
+                }
+                if (!outfile) {
+                    std::cout << "[WARNING] Cannot append to \"" << job.filename << "\"" << std::endl;
+                }
+                continue;
+            }
+
+            if (job.type == JobType::Write) {
+                writeFile(job);
+            } else {
+                std::error_code error;
+                std::filesystem::create_directories(job.filename, error);
+                if (error) {
+                    std::cout << "[WARNING] Cannot create \"" << job.filename << "\": " << error.message() << std::endl;
+                }
+            }
+            ++i;
+        }
+    }
+
+    static void writeFile(Job const& job)
+    {
+        std::string const tmp_filename = job.filename + ".tmp";
+        {
+            std::ofstream outfile{tmp_filename, std::ios::out | std::ios::binary | std::ios::trunc};
+            outfile.write(job.data.data(), static_cast<std::streamsize>(job.data.size()));
+            if (!outfile) {
+                std::cout << "[WARNING] Cannot write \"" << job.filename << "\"" << std::endl;
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(tmp_filename, job.filename, error);
+        if (error) {
+            std::cout << "[WARNING] Cannot write \"" << job.filename << "\": " << error.message() << std::endl;
+        }
+    }
+};
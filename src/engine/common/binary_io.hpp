@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <string>
+#include <vector>
 
 
 struct BinaryWriter
@@ -68,3 +72,245 @@ struct BinaryReader
         infile.read(reinterpret_cast<char*>(&value), sizeof(TValue));
     }
 };
+
+
+/// Same interface as BinaryWriter but writes into a memory buffer
+struct BinaryBufferWriter
+{
+    std::vector<char> buffer;
+
+    template<typename TValue>
+    void write(const TValue& value)
+    {
+        writeBytes(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeBytes(const char* data, uint64_t size)
+    {
+        buffer.insert(buffer.end(), data, data + size);
+    }
+
+    void writeString(const std::string& str)
+    {
+        write(static_cast<uint64_t>(str.size()));
+        writeBytes(str.data(), str.size());
+    }
+
+    [[nodiscard]]
+    uint64_t getSize() const
+    {
+        return buffer.size();
+    }
+};
+
+/// Same interface as BinaryReader but reads from a memory buffer
+struct BinaryBufferReader
+{
+    const char* data   = nullptr;
+    uint64_t    size   = 0;
+    uint64_t    cursor = 0;
+    bool        valid  = true;
+
+    BinaryBufferReader(const char* data_, uint64_t size_)
+        : data{data_}
+        , size{size_}
+    {}
+
+    [[nodiscard]]
+    bool isValid() const
+    {
+        return valid;
+    }
+
+    template<typename TValue>
+    TValue read()
+    {
+        TValue result = {};
+        readInto(result);
+        return result;
+    }
+
+    template<typename TValue>
+    void readInto(TValue& value)
+    {
+        readBytes(reinterpret_cast<char*>(&value), sizeof(TValue));
+    }
+
+    void readBytes(char* target, uint64_t count)
+    {
+        if (!valid || count > size - cursor) {
+            valid = false;
+            return;
+        }
+        std::memcpy(target, data + cursor, count);
+        cursor += count;
+    }
+
+    /// Returns the data at the cursor position, to decode it in place
+    [[nodiscard]]
+    const char* getCurrent() const
+    {
+        return data + cursor;
+    }
+
+    [[nodiscard]]
+    uint64_t getRemaining() const
+    {
+        return valid ? size - cursor : 0;
+    }
+
+    void skip(uint64_t count)
+    {
+        if (!valid || count > size - cursor) {
+            valid = false;
+            return;
+        }
+        cursor += count;
+    }
+
+    std::string readString()
+    {
+        auto const length = read<uint64_t>();
+        if (!valid || length > size - cursor) {
+            valid = false;
+            return {};
+        }
+        std::string result(data + cursor, length);
+        cursor += length;
+        return result;
+    }
+};
+
+/// FNV-1a hash, used to detect corrupted files
+inline uint64_t computeChecksum(const char* data, uint64_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (uint64_t i{0}; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/// Little-endian encoding of fixed size values, independent of the host byte order and of structs padding
+namespace le
+{
+inline void writeU8(std::vector<char>& out, uint8_t value)
+{
+    out.push_back(static_cast<char>(value));
+}
+
+inline void writeU32(std::vector<char>& out, uint32_t value)
+{
+    for (uint32_t i{0}; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+inline void writeU64(std::vector<char>& out, uint64_t value)
+{
+    for (uint32_t i{0}; i < 8; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+/// Overwrites a value previously written, used to patch headers
+inline void storeU32(char* target, uint32_t value)
+{
+    for (uint32_t i{0}; i < 4; ++i) {
+        target[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+inline void storeU64(char* target, uint64_t value)
+{
+    for (uint32_t i{0}; i < 8; ++i) {
+        target[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+/// Doubles are stored as their IEEE-754 binary64 representation
+inline void writeF64(std::vector<char>& out, double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeU64(out, bits);
+}
+
+[[nodiscard]]
+inline uint8_t readU8(const char* data)
+{
+    return static_cast<uint8_t>(data[0]);
+}
+
+[[nodiscard]]
+inline uint32_t readU32(const char* data)
+{
+    uint32_t result = 0;
+    for (uint32_t i{0}; i < 4; ++i) {
+        result |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    return result;
+}
+
+[[nodiscard]]
+inline uint64_t readU64(const char* data)
+{
+    uint64_t result = 0;
+    for (uint32_t i{0}; i < 8; ++i) {
+        result |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    }
+    return result;
+}
+
+[[nodiscard]]
+inline double readF64(const char* data)
+{
+    uint64_t const bits = readU64(data);
+    double result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+}
+
+/// LEB128 variable length encoding, small values take less bytes. Signed values are zigzag encoded first
+namespace varint
+{
+inline void writeU64(std::vector<char>& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline void writeI64(std::vector<char>& out, int64_t value)
+{
+    writeU64(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+/// Decodes the value at data and advances it, returns false if the value doesn't end before end
+inline bool readU64(const char*& data, const char* end, uint64_t& value)
+{
+    value = 0;
+    for (uint32_t shift{0}; data < end && shift < 64; shift += 7) {
+        auto const byte = static_cast<uint8_t>(*data++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool readI64(const char*& data, const char* end, int64_t& value)
+{
+    uint64_t encoded;
+    if (!readU64(data, end, encoded)) {
+        return false;
+    }
+    value = static_cast<int64_t>(encoded >> 1) ^ -static_cast<int64_t>(encoded & 1);
+    return true;
+}
+}
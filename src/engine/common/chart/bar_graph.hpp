@@ -4,13 +4,21 @@
 #include "engine/engine.hpp"
 #include "engine/common/math.hpp"
 #include "engine/common/racc.hpp"
+#include "engine/common/chart/sliding_extremes.hpp"
 #include "engine/render/render_context.hpp"
 
+/** Bars of the last values of a series.
+ *  Once the graph is full, adding a value shifts the heights of the existing bars and writes the newest one,
+ *  the whole geometry is only rebuilt when the number of bars or the extremes change.
+ */
 struct BarGraph
 {
     // Data
     RAccBase<float> data;
-    Vec2            extremes     = {};
+    /// Range always displayed, extended by the extremes of the values
+    Vec2            base_extremes = {};
+    Vec2            extremes      = {};
+    SlidingExtremes<float> data_extremes;
     uint32_t        samples_count = 0;
 
     // Geometry
@@ -45,8 +53,24 @@ struct BarGraph
     {
         ++samples_count;
         data.addValueBase(value);
-        extremes = {std::min(extremes.x, value), std::max(extremes.y, value)};
-        updateGeometry();
+        data_extremes.window_size = data.max_values_count;
+        data_extremes.add(value);
+
+        Vec2 const new_extremes = {std::min(base_extremes.x, data_extremes.getMin()), std::max(base_extremes.y, data_extremes.getMax())};
+        bool const extremes_changed = (new_extremes.x != extremes.x) || (new_extremes.y != extremes.y);
+        extremes = new_extremes;
+
+        uint32_t const slice_size = data.getCount();
+        if (extremes_changed || va_bar.getVertexCount() != 4 * slice_size) {
+            updateGeometry();
+            return;
+        }
+        // Bars do not move, the heights are shifted by one bar
+        for (uint32_t i{0}; i < 4 * (slice_size - 1); ++i) {
+            va_bar[i].position.y   = va_bar[i + 4].position.y;
+            va_lines[i].position.y = va_lines[i + 4].position.y;
+        }
+        updateBar(slice_size - 1, value);
     }
 
     void setPosition(Vec2 pos)
@@ -57,6 +81,19 @@ struct BarGraph
     }
 
     void updateGeometry()
+    {
+        // Update array sizes
+        uint32_t const slice_size = data.getCount();
+        va_bar.resize(4 * slice_size);
+        va_lines.resize(4 * slice_size);
+
+        // Update geometry
+        data.foreach([&](uint32_t i, float v) {
+            updateBar(i, v);
+        });
+    }
+
+    void updateBar(uint32_t i, float v)
     {
         // Compute width
         uint32_t const slice_size      = data.getCount();
@@ -67,49 +104,44 @@ struct BarGraph
         float const height_coef = size.y / (extremes.y - extremes.x);
         float const zero_y      = size.y - extremes.x * height_coef;
 
-        // Update array sizes
-        va_bar.resize(4 * slice_size);
-        va_lines.resize(4 * slice_size);
-
-        // Update geometry
-        data.foreach([&](uint32_t i, float v) {
-            float const height = v * height_coef;
-            float const x      = to<float>(i) * (bar_width + space_x);
-            float const y      = zero_y - height;
-            va_bar[4 * i + 0].position = {x            , zero_y};
-            va_bar[4 * i + 1].position = {x            , y};
-            va_bar[4 * i + 2].position = {x + bar_width, y};
-            va_bar[4 * i + 3].position = {x + bar_width, zero_y};
-
-            sf::Color const color = {accent_color.r, accent_color.g, accent_color.b, 50};
-            va_bar[4 * i + 0].color = color;
-            va_bar[4 * i + 1].color = color;
-            va_bar[4 * i + 2].color = color;
-            va_bar[4 * i + 3].color = color;
-
-            float const header_size = std::min(header_height, std::abs(height));
-            float const header_dir  = (height > 0.0f) ? -1.0f : 1.0f;
-            va_lines[4 * i + 0].position = {x            , y + header_dir * header_size};
-            va_lines[4 * i + 1].position = {x            , y};
-            va_lines[4 * i + 2].position = {x + bar_width, y};
-            va_lines[4 * i + 3].position = {x + bar_width, y + header_dir * header_size};
-            va_lines[4 * i + 0].color = accent_color;
-            va_lines[4 * i + 1].color = accent_color;
-            va_lines[4 * i + 2].color = accent_color;
-            va_lines[4 * i + 3].color = accent_color;
-        });
+        float const height = v * height_coef;
+        float const x      = to<float>(i) * (bar_width + space_x);
+        float const y      = zero_y - height;
+        va_bar[4 * i + 0].position = {x            , zero_y};
+        va_bar[4 * i + 1].position = {x            , y};
+        va_bar[4 * i + 2].position = {x + bar_width, y};
+        va_bar[4 * i + 3].position = {x + bar_width, zero_y};
+
+        sf::Color const color = {accent_color.r, accent_color.g, accent_color.b, 50};
+        va_bar[4 * i + 0].color = color;
+        va_bar[4 * i + 1].color = color;
+        va_bar[4 * i + 2].color = color;
+        va_bar[4 * i + 3].color = color;
+
+        float const header_size = std::min(header_height, std::abs(height));
+        float const header_dir  = (height > 0.0f) ? -1.0f : 1.0f;
+        va_lines[4 * i + 0].position = {x            , y + header_dir * header_size};
+        va_lines[4 * i + 1].position = {x            , y};
+        va_lines[4 * i + 2].position = {x + bar_width, y};
+        va_lines[4 * i + 3].position = {x + bar_width, y + header_dir * header_size};
+        va_lines[4 * i + 0].color = accent_color;
+        va_lines[4 * i + 1].color = accent_color;
+        va_lines[4 * i + 2].color = accent_color;
+        va_lines[4 * i + 3].color = accent_color;
     }
 
     void setColor(sf::Color color)
     {
         accent_color = color;
+        updateGeometry();
     }
 
     void clear()
     {
         data.clear();
+        data_extremes.clear();
         samples_count = 0;
-        extremes = {0.0f, 0.0f};
+        extremes = base_extremes;
         va_bar.clear();
         va_lines.clear();
     }
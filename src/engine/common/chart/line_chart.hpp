@@ -1,18 +1,30 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 #include "engine/engine.hpp"
 #include "engine/common/math.hpp"
 #include "engine/common/racc.hpp"
 #include "engine/common/utils.hpp"
+#include "engine/common/chart/sliding_extremes.hpp"
 #include "engine/render/render_context.hpp"
 
 
+/** Scrolling chart of the last values of a series.
+ *  Geometry is updated incrementally: adding a value writes the newest segment and, once the chart is full,
+ *  shifts the existing vertices by one step. Everything is rebuilt only when the extremes change.
+ *  When there are more values than pixels, values are decimated into buckets plotted as their minimum and maximum.
+ */
 struct LineChart
 {
     // Data
     RAccBase<float> values;
+    /// Range always displayed, extended by the extremes of the values
+    Vec2            base_extremes = {};
     Vec2            extremes;
+    SlidingExtremes<float> values_extremes;
 
     sf::Vector2f    position;
     sf::Vector2f    size;
@@ -29,6 +41,18 @@ struct LineChart
     bool draw_area = true;
     bool draw_line = true;
 
+    // Plotted points, one per value or two per bucket when decimating
+    std::vector<float> plot;
+    uint32_t           bucket_size    = 1;
+    uint32_t           plot_capacity  = 0;
+    float              plot_dx        = 0.0f;
+    /// Global index of the first plotted bucket
+    uint32_t           first_bucket   = 0;
+    /// Current bucket
+    float              bucket_min     = 0.0f;
+    float              bucket_max     = 0.0f;
+    bool               min_first      = true;
+
     explicit
     LineChart(sf::Vector2f size_)
         : values(100)
@@ -41,96 +65,55 @@ struct LineChart
     void clear()
     {
         values.clear();
+        values_extremes.clear();
         values_added = 0;
-        extremes = {0.0f, 0.0f};
+        extremes = base_extremes;
+        plot.clear();
+        first_bucket = 0;
         va_line.clear();
         va_area.clear();
     }
 
-    void addValue(float new_value) {
+    void addValue(float new_value)
+    {
         ++values_added;
-
         values.addValueBase(new_value);
-
-        if (new_value < extremes.x) {
-            extremes.x = new_value;
-        }
-        if (new_value > extremes.y) {
-            extremes.y = new_value;
+        values_extremes.window_size = values.max_values_count;
+        values_extremes.add(new_value);
+
+        Vec2 const new_extremes = getExtremes();
+        bool const extremes_changed = (new_extremes.x != extremes.x) || (new_extremes.y != extremes.y);
+        extremes = new_extremes;
+
+        if (updateLayout()) {
+            // The number of values or the size changed, buckets have to be built again
+            rebuildPlot();
+            rebuildGeometry();
+            return;
         }
 
-        uint32_t const count = values.getCount();
-        float const alpha_max_height = 1.0f / std::max(std::abs(extremes.x), std::abs(extremes.y));
-        float const dx = size.x / float(count - 1);
-
-        va_area.resize(2 * count);
-        values.foreach([&](uint32_t i, float v) {
-            float const normalized_x = to<float>(i) * dx + position.x;
-            float const scaled_y     = getScaledY(v);
-            va_area[2 * i].position = {normalized_x, scaled_y};
-
-            float const alpha_ratio = std::abs(v) * alpha_max_height;
-            auto const  alpha       = to<uint8_t>(std::min(1.0f, 2.0f * alpha_ratio) * 150.0f);
-            sf::Color const area_color{color.r, color.g, color.b, alpha};
-            va_area[2 * i].color = area_color;
-
-            va_area[2 * i + 1].position = {normalized_x, getScaledY(0.0f)};
-            va_area[2 * i + 1].color = {color.r, color.g, color.b, 0};
-        });
-
-        if (draw_line) {
-            va_line.resize(2 * count);
-            if (count > 1) {
-                Vec2 last_v{MathVec2::normalize(getPoint(1) - getPoint(0))};
-                Vec2 last_n{MathVec2::normal(last_v)};
-
-                va_line[0].position = getPoint(0) + Vec2{0, line_thickness};
-                va_line[0].color = color;
-                va_line[1].position = getPoint(0) - Vec2{0, line_thickness};
-                va_line[1].color = color;
-
-                for (uint32_t i{2}; i < count; ++i) {
-                    Vec2 const v = MathVec2::normalize(getPoint(i) - getPoint(i - 1));
-                    Vec2 const n = MathVec2::normal(v);
-
-                    float const dot = MathVec2::dot(last_v, v);
-
-                    auto const computeGeometry = [&](uint32_t idx, float normal_direction, float dot_result) {
-                        constexpr float threshold = 0.9f;
-                        float const     normal    = line_thickness * normal_direction;
-
-                        if (dot < threshold) {
-                            Vec2 const pt_1 = getPoint(i) + n * normal;
-                            Vec2 const pt_2 = getPoint(i - 1) + last_n * normal;
-                            va_line[idx].position = getIntersection(pt_1, v, pt_2, last_v);
-                            va_line[idx].color = color;
-                        } else {
-                            Vec2 const pt_1 = getPoint(i - 1) + n * normal;
-                            va_line[idx].position = pt_1;
-                            va_line[idx].color = color;
-                        }
-                    };
-
-                    computeGeometry(2 * (i - 1)    ,  1.0f, dot);
-                    computeGeometry(2 * (i - 1) + 1, -1.0f, dot);
-
-                    last_v = v;
-                    last_n = n;
-                }
-
-                va_line[2 * (count - 1)].position = getPoint(count - 1) + line_thickness * Vec2{0, 1};
-                va_line[2 * (count - 1)].color = color;
-
-                va_line[2 * (count - 1) + 1].position = getPoint(count - 1) - line_thickness * Vec2{0, 1};
-                va_line[2 * (count - 1) + 1].color = color;
-            }
+        plotValue(values_added - 1, new_value, !extremes_changed);
+        if (extremes_changed) {
+            rebuildGeometry();
         }
     }
 
     [[nodiscard]]
     Vec2 getPoint(uint32_t i) const
     {
-        return va_area[2 * i].position;
+        // The oldest bucket can hold values that already left the window and the extremes
+        return {to<float>(i) * plot_dx, getScaledY(std::clamp(plot[i], extremes.x, extremes.y)) - position.y};
+    }
+
+    /// Horizontal position of a value of the buffer, relative to the chart's position
+    [[nodiscard]]
+    float getValueX(uint32_t data_buffer_idx) const
+    {
+        uint32_t const global_idx = getGlobalValueIndex(data_buffer_idx);
+        if (bucket_size == 1) {
+            return to<float>(global_idx - first_bucket) * plot_dx;
+        }
+        return (to<float>(2 * (global_idx / bucket_size - first_bucket)) + 0.5f) * plot_dx;
     }
 
     [[nodiscard]]
@@ -151,14 +134,16 @@ struct LineChart
         return {px, py}; // return statement
     }
 
-    void render(pez::render::Context& context) const
+    void render(pez::render::Context& context)
     {
+        sf::Transform transform;
+        transform.translate(position);
         if (draw_area) {
-            context.drawDirect(va_area);
+            context.drawDirect(va_area, transform);
         }
 
         if (draw_line) {
-            context.drawDirect(va_line);
+            context.drawDirect(va_line, transform);
         }
     }
 
@@ -180,5 +165,209 @@ struct LineChart
     void setColor(sf::Color c)
     {
         color = c;
+        rebuildGeometry();
+    }
+
+private:
+    [[nodiscard]]
+    Vec2 getExtremes() const
+    {
+        if (values_extremes.isEmpty()) {
+            return base_extremes;
+        }
+        return {std::min(base_extremes.x, values_extremes.getMin()), std::max(base_extremes.y, values_extremes.getMax())};
+    }
+
+    /// Returns true if the layout changed
+    bool updateLayout()
+    {
+        uint32_t const max_points = std::max(2u, to<uint32_t>(size.x));
+        uint32_t const max_count  = std::max(2u, values.max_values_count);
+        uint32_t new_bucket_size  = 1;
+        uint32_t new_capacity     = max_count;
+        if (max_count > max_points) {
+            // Two points per bucket, plus one partially out of the window
+            new_bucket_size = (2 * max_count + max_points - 1) / max_points;
+            new_capacity    = 2 * ((max_count + new_bucket_size - 1) / new_bucket_size + 1);
+        }
+        float const new_dx = size.x / to<float>(new_capacity - 1);
+        bool const changed = (new_bucket_size != bucket_size) || (new_capacity != plot_capacity) || (new_dx != plot_dx);
+        bucket_size   = new_bucket_size;
+        plot_capacity = new_capacity;
+        plot_dx       = new_dx;
+        return changed;
+    }
+
+    void rebuildPlot()
+    {
+        plot.clear();
+        first_bucket = getGlobalValueIndex(0) / bucket_size;
+        values.foreach([&](uint32_t i, float v) {
+            plotValue(getGlobalValueIndex(i), v, false);
+        });
+    }
+
+    /** Adds a value to the plotted points
+     *
+     * @param update_geometry If false only the points are updated, the geometry has to be rebuilt after
+     */
+    void plotValue(uint32_t global_idx, float v, bool update_geometry)
+    {
+        if (bucket_size == 1) {
+            if (plot.size() >= plot_capacity) {
+                popFront(1, update_geometry);
+            }
+            pushPoint(v, update_geometry);
+            return;
+        }
+
+        // Remove the buckets that left the window
+        uint32_t const window_first_bucket = getGlobalValueIndex(0) / bucket_size;
+        while (!plot.empty() && first_bucket < window_first_bucket) {
+            popFront(2, update_geometry);
+        }
+
+        if (global_idx % bucket_size == 0 || plot.empty()) {
+            bucket_min = v;
+            bucket_max = v;
+            min_first  = true;
+            pushPoint(v, update_geometry);
+            pushPoint(v, update_geometry);
+            return;
+        }
+
+        // Points are kept in the order the extremes were reached
+        if (v < bucket_min) {
+            bucket_min = v;
+            min_first  = false;
+        } else if (v > bucket_max) {
+            bucket_max = v;
+            min_first  = true;
+        }
+        int32_t const last = to<int32_t>(plot.size()) - 1;
+        plot[last - 1] = min_first ? bucket_min : bucket_max;
+        plot[last]     = min_first ? bucket_max : bucket_min;
+        if (update_geometry) {
+            writeArea(last - 1);
+            writeArea(last);
+            writeLineRange(last - 2, last);
+        }
+    }
+
+    void pushPoint(float v, bool update_geometry)
+    {
+        plot.push_back(v);
+        if (!update_geometry) {
+            return;
+        }
+        auto const count = to<int32_t>(plot.size());
+        va_area.resize(2 * count);
+        va_line.resize(2 * count);
+        writeArea(count - 1);
+        writeLineRange(count - 2, count - 1);
+    }
+
+    /// Removes the oldest points and shifts the remaining ones to the left
+    void popFront(uint32_t count, bool update_geometry)
+    {
+        plot.erase(plot.begin(), plot.begin() + count);
+        first_bucket += (bucket_size == 1) ? count : 1;
+        if (!update_geometry) {
+            return;
+        }
+        auto const  remaining = to<uint32_t>(plot.size());
+        float const shift     = to<float>(count) * plot_dx;
+        shiftVertices(va_area, 2 * count, shift);
+        shiftVertices(va_line, 2 * count, shift);
+        va_area.resize(2 * remaining);
+        va_line.resize(2 * remaining);
+        // The first point became an extremity
+        writeLineRange(0, 0);
+    }
+
+    static void shiftVertices(sf::VertexArray& va, uint32_t offset, float shift)
+    {
+        uint32_t const count = to<uint32_t>(va.getVertexCount()) - offset;
+        for (uint32_t i{0}; i < count; ++i) {
+            va[i] = va[i + offset];
+            va[i].position.x -= shift;
+        }
+    }
+
+    void rebuildGeometry()
+    {
+        auto const count = to<uint32_t>(plot.size());
+        va_area.resize(2 * count);
+        va_line.resize(2 * count);
+        for (uint32_t i{0}; i < count; ++i) {
+            writeArea(i);
+        }
+        writeLineRange(0, to<int32_t>(count) - 1);
+    }
+
+    void writeArea(uint32_t i)
+    {
+        float const alpha_max_height = 1.0f / std::max(std::abs(extremes.x), std::abs(extremes.y));
+        Vec2 const  point = getPoint(i);
+        va_area[2 * i].position = point;
+
+        float const alpha_ratio = std::abs(plot[i]) * alpha_max_height;
+        auto const  alpha       = to<uint8_t>(std::min(1.0f, 2.0f * alpha_ratio) * 150.0f);
+        va_area[2 * i].color = {color.r, color.g, color.b, alpha};
+
+        va_area[2 * i + 1].position = {point.x, getScaledY(0.0f) - position.y};
+        va_area[2 * i + 1].color    = {color.r, color.g, color.b, 0};
+    }
+
+    /// Line vertices of the points in [first, last], each one depends on its neighbors
+    void writeLineRange(int32_t first, int32_t last)
+    {
+        auto const count = to<int32_t>(plot.size());
+        for (int32_t i{std::max(first, 0)}; i <= last && i < count; ++i) {
+            writeLine(to<uint32_t>(i));
+        }
+    }
+
+    void writeLine(uint32_t i)
+    {
+        auto const count = to<uint32_t>(plot.size());
+        if (count < 2) {
+            va_line[2 * i].position     = getPoint(i);
+            va_line[2 * i + 1].position = getPoint(i);
+            return;
+        }
+
+        va_line[2 * i].color     = color;
+        va_line[2 * i + 1].color = color;
+        // Extremities
+        if (i == 0 || i == count - 1) {
+            va_line[2 * i].position     = getPoint(i) + Vec2{0, line_thickness};
+            va_line[2 * i + 1].position = getPoint(i) - Vec2{0, line_thickness};
+            return;
+        }
+
+        Vec2 const last_v{MathVec2::normalize(getPoint(i) - getPoint(i - 1))};
+        Vec2 const last_n{MathVec2::normal(last_v)};
+        Vec2 const v = MathVec2::normalize(getPoint(i + 1) - getPoint(i));
+        Vec2 const n = MathVec2::normal(v);
+
+        float const dot = MathVec2::dot(last_v, v);
+
+        auto const computeGeometry = [&](uint32_t idx, float normal_direction) {
+            constexpr float threshold = 0.9f;
+            float const     normal    = line_thickness * normal_direction;
+
+            if (dot < threshold) {
+                Vec2 const pt_1 = getPoint(i + 1) + n * normal;
+                Vec2 const pt_2 = getPoint(i) + last_n * normal;
+                va_line[idx].position = getIntersection(pt_1, v, pt_2, last_v);
+            } else {
+                Vec2 const pt_1 = getPoint(i) + n * normal;
+                va_line[idx].position = pt_1;
+            }
+        };
+
+        computeGeometry(2 * i    ,  1.0f);
+        computeGeometry(2 * i + 1, -1.0f);
     }
 };
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+
+/** Minimum and maximum of the last window_size values of a series.
+ *  Each deque only keeps the values that can still become an extreme, in monotonic order, so adding a value
+ *  is constant time amortized and the extremes are the fronts of the deques.
+ */
+template<typename T>
+struct SlidingExtremes
+{
+    uint32_t window_size = 1;
+    /// Number of values added since the last clear
+    uint64_t count       = 0;
+
+    std::deque<std::pair<uint64_t, T>> min_queue;
+    std::deque<std::pair<uint64_t, T>> max_queue;
+
+    void add(T value)
+    {
+        while (!min_queue.empty() && min_queue.back().second >= value) {
+            min_queue.pop_back();
+        }
+        min_queue.emplace_back(count, value);
+        while (!max_queue.empty() && max_queue.back().second <= value) {
+            max_queue.pop_back();
+        }
+        max_queue.emplace_back(count, value);
+        ++count;
+
+        // Remove the values that left the window
+        while (min_queue.front().first + window_size < count) {
+            min_queue.pop_front();
+        }
+        while (max_queue.front().first + window_size < count) {
+            max_queue.pop_front();
+        }
+    }
+
+    void clear()
+    {
+        count = 0;
+        min_queue.clear();
+        max_queue.clear();
+    }
+
+    [[nodiscard]]
+    bool isEmpty() const
+    {
+        return count == 0;
+    }
+
+    [[nodiscard]]
+    T getMin() const
+    {
+        return min_queue.front().second;
+    }
+
+    [[nodiscard]]
+    T getMax() const
+    {
+        return max_queue.front().second;
+    }
+};
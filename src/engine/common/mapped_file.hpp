@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define PEZ_MAPPED_FILE_MMAP
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+/** Read only view of a whole file.
+ *  The file is memory-mapped when the platform allows it, its pages are only loaded when accessed.
+ *  On other platforms the file is read in a buffer.
+ */
+class MappedFile
+{
+public:
+    explicit
+    MappedFile(std::string const& filename)
+    {
+#ifdef PEZ_MAPPED_FILE_MMAP
+        int const fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat file_stat{};
+        if (::fstat(fd, &file_stat) == 0) {
+            m_size = static_cast<uint64_t>(file_stat.st_size);
+            m_valid = true;
+            if (m_size > 0) {
+                void* const mapped = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED) {
+                    m_size  = 0;
+                    m_valid = false;
+                } else {
+                    m_data = static_cast<const char*>(mapped);
+                }
+            }
+        }
+        ::close(fd);
+#else
+        std::ifstream infile{filename, std::ios::binary};
+        if (!infile) {
+            return;
+        }
+        m_buffer.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+        m_data  = m_buffer.data();
+        m_size  = m_buffer.size();
+        m_valid = true;
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifdef PEZ_MAPPED_FILE_MMAP
+        if (m_data) {
+            ::munmap(const_cast<char*>(m_data), m_size);
+        }
+#endif
+    }
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    [[nodiscard]]
+    bool isValid() const
+    {
+        return m_valid;
+    }
+
+    [[nodiscard]]
+    const char* getData() const
+    {
+        return m_data;
+    }
+
+    [[nodiscard]]
+    uint64_t getSize() const
+    {
+        return m_size;
+    }
+
+private:
+    const char*       m_data  = nullptr;
+    uint64_t          m_size  = 0;
+    bool              m_valid = false;
+    std::vector<char> m_buffer;
+};
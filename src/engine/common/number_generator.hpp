@@ -1,5 +1,7 @@
 #pragma once
 #include <random>
+#include <sstream>
+#include <string>
 
 
 class NumberGenerator
@@ -17,6 +19,21 @@ public:
     {
         gen = std::mt19937{seed};
     }
+
+    /// Returns the full state of the engine, allowing to resume the exact same sequence later
+    [[nodiscard]]
+    std::string getState() const
+    {
+        std::stringstream ss;
+        ss << gen;
+        return ss.str();
+    }
+
+    void setState(std::string const& state)
+    {
+        std::stringstream ss{state};
+        ss >> gen;
+    }
 };
 
 
@@ -106,6 +123,16 @@ public:
     {
         gen.setSeed(seed);
     }
+
+    static std::string getState()
+    {
+        return gen.getState();
+    }
+
+    static void setState(std::string const& state)
+    {
+        gen.setState(state);
+    }
 };
 
 using RNGf = RNG<float>;
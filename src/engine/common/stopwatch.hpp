@@ -0,0 +1,34 @@
+#pragma once
+#include <chrono>
+
+
+/// Measures wall clock time, unlike pez::core::Timer that relies on the simulation time
+struct Stopwatch
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point start = Clock::now();
+
+    void reset()
+    {
+        start = Clock::now();
+    }
+
+    [[nodiscard]]
+    uint64_t getElapsedNs() const
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+    [[nodiscard]]
+    float getElapsedMs() const
+    {
+        return static_cast<float>(getElapsedNs()) * 1.0e-6f;
+    }
+
+    [[nodiscard]]
+    float getElapsedSeconds() const
+    {
+        return static_cast<float>(getElapsedNs()) * 1.0e-9f;
+    }
+};
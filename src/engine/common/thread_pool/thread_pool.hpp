@@ -7,6 +7,7 @@
 #include <atomic>
 
 #include "engine/engine.hpp"
+#include "engine/common/stopwatch.hpp"
 
 
 namespace tp
@@ -63,6 +64,8 @@ struct Worker
     std::function<void()> m_task    = nullptr;
     bool                  m_running = true;
     TaskQueue*            m_queue   = nullptr;
+    // Time spent executing tasks, only safe to read when no task is pending
+    uint64_t              m_busy_ns = 0;
 
     Worker() = default;
 
@@ -82,7 +85,9 @@ struct Worker
             if (m_task == nullptr) {
                 TaskQueue::wait();
             } else {
+                Stopwatch const stopwatch;
                 m_task();
+                m_busy_ns += stopwatch.getElapsedNs();
                 m_queue->workDone();
                 m_task = nullptr;
             }
@@ -101,6 +106,8 @@ struct ThreadPool
     uint32_t            m_thread_count = 0;
     TaskQueue           m_queue;
     std::vector<Worker> m_workers;
+    /// Time the dispatching thread spent executing the remainder of the dispatched batches
+    uint64_t            m_caller_busy_ns = 0;
 
     explicit
     ThreadPool(uint32_t thread_count)
@@ -142,12 +149,36 @@ struct ThreadPool
 
         if (batch_size * m_thread_count < element_count) {
             const uint32_t start = batch_size * m_thread_count;
+            Stopwatch const stopwatch;
             callback(start, element_count);
+            m_caller_busy_ns += stopwatch.getElapsedNs();
         }
 
         waitForCompletion();
     }
 
+    /// Returns the time the worker spent executing tasks since the last reset
+    [[nodiscard]]
+    uint64_t getBusyTimeNs(uint32_t worker_idx) const
+    {
+        return m_workers[worker_idx].m_busy_ns;
+    }
+
+    /// Returns the time the dispatching thread spent executing batches since the last reset
+    [[nodiscard]]
+    uint64_t getCallerBusyTimeNs() const
+    {
+        return m_caller_busy_ns;
+    }
+
+    void resetBusyTime()
+    {
+        m_caller_busy_ns = 0;
+        for (Worker& worker : m_workers) {
+            worker.m_busy_ns = 0;
+        }
+    }
+
     template<typename TContainer, typename TCallback>
     void map(TContainer& container, TCallback&& callback)
     {
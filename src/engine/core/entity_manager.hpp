@@ -18,6 +18,7 @@ struct EntityManager
 
     uint32_t                      class_count    = 0;
     std::vector<ProcessCallback>  update_callbacks;
+    std::vector<VoidCallback>     prepare_callbacks;
     std::vector<RenderCallback>   render_callbacks;
     std::vector<VoidCallback>     pre_remove_callbacks;
     std::vector<VoidCallback>     remove_callbacks;
@@ -75,6 +76,7 @@ struct EntityManager
         }
         static_assert(std::is_convertible<T*, IRenderer*>::value, "Provided class is not a Renderer");
         System<T>::create(std::forward<Arg>(args)...);
+        prepare_callbacks.push_back(Renderer<T>::prepare);
         render_callbacks.push_back(Renderer<T>::render);
         on_stop_callbacks.push_back(System<T>::stop);
         clear_systems.push_back(System<T>::clear);
@@ -110,6 +112,13 @@ struct EntityManager
         }
     }
 
+    void prepare()
+    {
+        for (const VoidCallback& f : prepare_callbacks) {
+            f();
+        }
+    }
+
     void render(pez::render::Context& context)
     {
         for (const RenderCallback& f : render_callbacks) {
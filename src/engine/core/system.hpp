@@ -20,6 +20,8 @@ struct IProcessor : public ISystem
 
 struct IRenderer : public ISystem
 {
+    /// Called before render, to build geometry on the thread pool, nothing is drawn
+    virtual void prepare() {}
     virtual void render(pez::render::Context& context) {}
 };
 
@@ -104,6 +106,11 @@ struct Processor
 template<typename T>
 struct Renderer
 {
+    static void prepare()
+    {
+        System<T>::instance->prepare();
+    }
+
     static void render(pez::render::Context& context)
     {
         System<T>::instance->render(context);
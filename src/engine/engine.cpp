@@ -16,6 +16,8 @@ void pez::core::quit()
 void pez::core::render(sf::Color clear_color)
 {
     pez::render::Context& context = *(GlobalInstance::instance->m_render_context);
+    // Renderers build their geometry, possibly in parallel, then all the draw calls are issued from this thread
+    GlobalInstance::instance->m_entity_manager.prepare();
     context.clear(clear_color);
     GlobalInstance::instance->m_entity_manager.render(context);
     context.display();
@@ -4,10 +4,29 @@
 #include <SFML/Graphics.hpp>
 
 #include "viewport_handler.hpp"
+#include "software_rasterizer.hpp"
 
 
 namespace pez::render
 {
+/// Static content rendered once in a texture and composited each frame, see Context::drawLayer
+struct Layer
+{
+    sf::RenderTexture texture;
+    /// State of the context the content has been rendered with
+    sf::Vector2u      size;
+    sf::Transform     transform;
+    bool              valid = false;
+    /// Content drawn in window pixels only (drawDirect), the viewport transform does not affect it
+    bool              screen_space = false;
+
+    /// Forces the content to be rendered again, for instance when it changed
+    void invalidate()
+    {
+        valid = false;
+    }
+};
+
 class Context
 {
 public:
@@ -46,12 +65,20 @@ public:
 
     void clear(sf::Color color = sf::Color::Black)
     {
-        m_window->clear(color);
+        if (m_software) {
+            m_software->clear(color);
+        } else {
+            m_window->clear(color);
+        }
     }
 
     void display()
     {
-        m_window->display();
+        if (m_software) {
+            m_software->finish();
+        } else {
+            m_window->display();
+        }
     }
 
     [[nodiscard]]
@@ -62,29 +89,67 @@ public:
 
     void draw(sf::Drawable& drawable)
     {
-        m_window->draw(drawable, m_viewport_handler.getTransform());
+        submit(drawable, m_viewport_handler.getTransform());
     }
 
     void draw(sf::Drawable& drawable, sf::Transform const& transform)
     {
-        m_window->draw(drawable, m_viewport_handler.getTransform() * transform);
+        submit(drawable, m_viewport_handler.getTransform() * transform);
     }
 
     void draw(sf::Drawable& drawable, sf::RenderStates const& states)
     {
         sf::RenderStates final_states = states;
         final_states.transform = m_viewport_handler.getTransform() * states.transform;
-        m_window->draw(drawable, final_states);
+        submit(drawable, final_states);
     }
 
     void drawDirect(sf::Drawable const& drawable, sf::BlendMode mode = sf::BlendNone)
     {
-        m_window->draw(drawable);
+        submit(drawable, sf::RenderStates::Default);
     }
 
     void drawDirect(sf::Drawable& drawable, sf::Transform const& transform)
     {
-        m_window->draw(drawable, transform);
+        submit(drawable, transform);
+    }
+
+    /** Composites a layer, its content is only rendered again when it has been invalidated,
+     *  when the window is resized or, for world space layers, when the viewport moved or zoomed.
+     *  The callback renders the content with this context, as it would directly in the window.
+     *  Without window, the content is rendered directly by the software rasterizer.
+     */
+    template<typename TCallback>
+    void drawLayer(Layer& layer, TCallback&& render)
+    {
+        if (m_software) {
+            render();
+            return;
+        }
+        sf::Vector2u const   size      = m_window->getSize();
+        sf::Transform const& transform = m_viewport_handler.getTransform();
+        bool const moved = !layer.screen_space && !isSameTransform(layer.transform, transform);
+        if (!layer.valid || layer.size != size || moved) {
+            if (layer.size != size) {
+                layer.texture.create(size.x, size.y, m_window->getSettings());
+                layer.size = size;
+            }
+            layer.texture.setView(m_window->getView());
+            layer.texture.clear(sf::Color::Transparent);
+            m_target = &layer.texture;
+            render();
+            m_target = m_window;
+            layer.texture.display();
+            layer.transform = transform;
+            layer.valid     = true;
+        }
+
+        // The texture is in window pixels, colors are already multiplied by their alpha
+        sf::View const view = m_window->getView();
+        m_window->setView(sf::View{sf::FloatRect{0.0f, 0.0f, static_cast<float>(size.x), static_cast<float>(size.y)}});
+        sf::Sprite const sprite{layer.texture.getTexture()};
+        m_window->draw(sprite, sf::RenderStates{sf::BlendMode{sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha}});
+        m_window->setView(view);
     }
 
     [[nodiscard]]
@@ -103,14 +168,49 @@ private:
     IVec2             m_render_size       = {};
     ViewportHandler   m_viewport_handler;
     sf::RenderWindow* m_window            = nullptr;
+    /// Where draw calls go, the window or a layer being rendered
+    sf::RenderTarget* m_target            = nullptr;
+    /// Replaces the window when rendering headless
+    SoftwareRasterizer* m_software        = nullptr;
+
+    void submit(sf::Drawable const& drawable, sf::RenderStates const& states)
+    {
+        if (m_software) {
+            m_software->draw(drawable, states);
+        } else {
+            m_target->draw(drawable, states);
+        }
+    }
 
     void setWindow(sf::RenderWindow& window)
     {
         m_window = &window;
+        m_target = &window;
         auto const window_size = static_cast<Vec2>(m_window->getSize());
         m_viewport_handler.state.setCenter(window_size * 0.5f);
     }
 
+    void setSoftwareTarget(SoftwareRasterizer& rasterizer)
+    {
+        m_software = &rasterizer;
+        auto const size = static_cast<Vec2>(rasterizer.getSize());
+        m_viewport_handler.state.setCenter(size * 0.5f);
+    }
+
+    [[nodiscard]]
+    static bool isSameTransform(sf::Transform const& a, sf::Transform const& b)
+    {
+        float const* const ma = a.getMatrix();
+        float const* const mb = b.getMatrix();
+        for (uint32_t i{0}; i < 16; ++i) {
+            if (ma[i] != mb[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     friend class WindowContextHandler;
+    friend class HeadlessContextHandler;
 };
 }
@@ -0,0 +1,645 @@
+#include "software_rasterizer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+
+#include "engine/engine.hpp"
+
+
+namespace pez::render
+{
+namespace
+{
+/// Rotated grid, no two samples share a row or a column
+std::array<sf::Vector2f, SoftwareRasterizer::sample_count> const sample_offsets = {{
+    {0.375f, 0.125f},
+    {0.875f, 0.375f},
+    {0.125f, 0.625f},
+    {0.625f, 0.875f},
+}};
+
+struct Edge
+{
+    float a    = 0.0f;
+    float b    = 0.0f;
+    float c    = 0.0f;
+    /// Points exactly on the edge belong to one of the two triangles sharing it
+    bool  bias = false;
+
+    Edge(sf::Vector2f p1, sf::Vector2f p2)
+        : a{p1.y - p2.y}
+        , b{p2.x - p1.x}
+        , c{p1.x * p2.y - p1.y * p2.x}
+        , bias{(p2.y > p1.y) || (p2.y == p1.y && p2.x < p1.x)}
+    {}
+
+    [[nodiscard]]
+    float evaluate(float x, float y) const
+    {
+        return a * x + b * y + c;
+    }
+
+    [[nodiscard]]
+    bool contains(float x, float y) const
+    {
+        float const value = evaluate(x, y);
+        return value > 0.0f || (value == 0.0f && bias);
+    }
+};
+
+[[nodiscard]]
+float cross(sf::Vector2f a, sf::Vector2f b, sf::Vector2f c)
+{
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+[[nodiscard]]
+float getFactor(sf::BlendMode::Factor factor, float const* src, float const* dst, uint32_t channel)
+{
+    switch (factor) {
+    case sf::BlendMode::Zero:             return 0.0f;
+    case sf::BlendMode::One:              return 1.0f;
+    case sf::BlendMode::SrcColor:         return src[channel];
+    case sf::BlendMode::OneMinusSrcColor: return 1.0f - src[channel];
+    case sf::BlendMode::DstColor:         return dst[channel];
+    case sf::BlendMode::OneMinusDstColor: return 1.0f - dst[channel];
+    case sf::BlendMode::SrcAlpha:         return src[3];
+    case sf::BlendMode::OneMinusSrcAlpha: return 1.0f - src[3];
+    case sf::BlendMode::DstAlpha:         return dst[3];
+    case sf::BlendMode::OneMinusDstAlpha: return 1.0f - dst[3];
+    }
+    return 1.0f;
+}
+
+[[nodiscard]]
+float applyEquation(sf::BlendMode::Equation equation, float src, float dst)
+{
+    switch (equation) {
+    case sf::BlendMode::Subtract:        return src - dst;
+    case sf::BlendMode::ReverseSubtract: return dst - src;
+    default:                             return src + dst;
+    }
+}
+
+/// Blends the normalized color into the sample
+void blend(uint8_t* target, std::array<float, 4> const& color, sf::BlendMode const& mode)
+{
+    float const dst[4] = {target[0] / 255.0f, target[1] / 255.0f, target[2] / 255.0f, target[3] / 255.0f};
+    float const* const src = color.data();
+    for (uint32_t c{0}; c < 4; ++c) {
+        bool const alpha = (c == 3);
+        float const src_factor = getFactor(alpha ? mode.alphaSrcFactor : mode.colorSrcFactor, src, dst, c);
+        float const dst_factor = getFactor(alpha ? mode.alphaDstFactor : mode.colorDstFactor, src, dst, c);
+        float const result = applyEquation(alpha ? mode.alphaEquation : mode.colorEquation, src[c] * src_factor, dst[c] * dst_factor);
+        target[c] = static_cast<uint8_t>(std::clamp(result, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+[[nodiscard]]
+sf::Vector2f computeNormal(sf::Vector2f p1, sf::Vector2f p2)
+{
+    sf::Vector2f normal{p1.y - p2.y, p2.x - p1.x};
+    float const length = std::sqrt(normal.x * normal.x + normal.y * normal.y);
+    if (length != 0.0f) {
+        normal /= length;
+    }
+    return normal;
+}
+
+/// Portable popcount, the masks only have sample_count bits
+[[nodiscard]]
+uint32_t countBits(uint32_t mask)
+{
+    uint32_t count = 0;
+    for (; mask; mask &= mask - 1) {
+        ++count;
+    }
+    return count;
+}
+}
+
+SoftwareRasterizer::SoftwareRasterizer(tp::ThreadPool& thread_pool)
+    : m_thread_pool{thread_pool}
+{}
+
+void SoftwareRasterizer::create(uint32_t width, uint32_t height)
+{
+    m_width   = width;
+    m_height  = height;
+    m_tiles_x = (width + tile_size - 1) / tile_size;
+    m_tiles_y = (height + tile_size - 1) / tile_size;
+    m_samples.assign(static_cast<uint64_t>(width) * height * sample_count * 4, 0);
+    m_pixels.assign(static_cast<uint64_t>(width) * height * 4, 0);
+    m_bins.assign(m_tiles_x * m_tiles_y, {});
+    m_triangles.clear();
+}
+
+void SoftwareRasterizer::clear(sf::Color color)
+{
+    m_clear_color = color;
+    m_triangles.clear();
+    m_images.clear();
+    m_image_indices.clear();
+}
+
+void SoftwareRasterizer::draw(sf::Drawable const& drawable, sf::RenderStates const& states)
+{
+    if (auto const* va = dynamic_cast<sf::VertexArray const*>(&drawable)) {
+        if (va->getVertexCount()) {
+            draw(&(*va)[0], va->getVertexCount(), va->getPrimitiveType(), states);
+        }
+    } else if (auto const* shape = dynamic_cast<sf::Shape const*>(&drawable)) {
+        drawShape(*shape, states);
+    } else if (auto const* sprite = dynamic_cast<sf::Sprite const*>(&drawable)) {
+        drawSprite(*sprite, states);
+    } else if (auto const* text = dynamic_cast<sf::Text const*>(&drawable)) {
+        drawText(*text, states);
+    } else if (!m_warned) {
+        std::cout << "[WARNING] Unsupported drawable skipped by the software rasterizer" << std::endl;
+        m_warned = true;
+    }
+}
+
+void SoftwareRasterizer::draw(sf::Vertex const* vertices, std::size_t count, sf::PrimitiveType type, sf::RenderStates const& states)
+{
+    int32_t const texture = getImage(states.texture);
+    switch (type) {
+    case sf::Points:
+        for (std::size_t i{0}; i < count; ++i) {
+            // One pixel square, built in window pixels
+            sf::Vertex a = vertices[i];
+            sf::Vertex b = vertices[i];
+            a.position = states.transform.transformPoint(a.position) - sf::Vector2f{0.5f, 0.0f};
+            b.position = a.position + sf::Vector2f{1.0f, 0.0f};
+            sf::RenderStates pixel_states = states;
+            pixel_states.transform = sf::Transform::Identity;
+            addLine(a, b, pixel_states, texture);
+        }
+        break;
+    case sf::Lines:
+        for (std::size_t i{1}; i < count; i += 2) {
+            addLine(vertices[i - 1], vertices[i], states, texture);
+        }
+        break;
+    case sf::LineStrip:
+        for (std::size_t i{1}; i < count; ++i) {
+            addLine(vertices[i - 1], vertices[i], states, texture);
+        }
+        break;
+    case sf::Triangles:
+        for (std::size_t i{2}; i < count; i += 3) {
+            addTriangle(vertices[i - 2], vertices[i - 1], vertices[i], states, texture);
+        }
+        break;
+    case sf::TriangleStrip:
+        for (std::size_t i{2}; i < count; ++i) {
+            addTriangle(vertices[i - 2], vertices[i - 1], vertices[i], states, texture);
+        }
+        break;
+    case sf::TriangleFan:
+        for (std::size_t i{2}; i < count; ++i) {
+            addTriangle(vertices[0], vertices[i - 1], vertices[i], states, texture);
+        }
+        break;
+    case sf::Quads:
+        for (std::size_t i{3}; i < count; i += 4) {
+            addTriangle(vertices[i - 3], vertices[i - 2], vertices[i - 1], states, texture);
+            addTriangle(vertices[i - 3], vertices[i - 1], vertices[i], states, texture);
+        }
+        break;
+    }
+}
+
+void SoftwareRasterizer::finish()
+{
+    for (auto& bin : m_bins) {
+        bin.clear();
+    }
+    auto const getTile = [](float coord, uint32_t tile_count) {
+        float const tile = std::floor(coord / static_cast<float>(tile_size));
+        return static_cast<uint32_t>(std::clamp(tile, 0.0f, static_cast<float>(tile_count - 1)));
+    };
+    for (uint32_t i{0}; i < m_triangles.size(); ++i) {
+        Triangle const& triangle = m_triangles[i];
+        uint32_t const tx_end = getTile(triangle.max.x, m_tiles_x);
+        uint32_t const ty_end = getTile(triangle.max.y, m_tiles_y);
+        for (uint32_t ty{getTile(triangle.min.y, m_tiles_y)}; ty <= ty_end; ++ty) {
+            for (uint32_t tx{getTile(triangle.min.x, m_tiles_x)}; tx <= tx_end; ++tx) {
+                m_bins[ty * m_tiles_x + tx].push_back(i);
+            }
+        }
+    }
+
+    // Tiles are picked one by one, their cost depends a lot on what they cover
+    uint32_t const tile_count = m_tiles_x * m_tiles_y;
+    std::atomic<uint32_t> next_tile{0};
+    auto const worker = [&] {
+        for (uint32_t tile{next_tile++}; tile < tile_count; tile = next_tile++) {
+            rasterizeTile(tile);
+        }
+    };
+    for (uint32_t i{0}; i < m_thread_pool.m_thread_count; ++i) {
+        m_thread_pool.addTask(worker);
+    }
+    worker();
+    m_thread_pool.waitForCompletion();
+}
+
+bool SoftwareRasterizer::saveToFile(std::string const& filename) const
+{
+    sf::Image image;
+    image.create(m_width, m_height, m_pixels.data());
+    return image.saveToFile(filename);
+}
+
+void SoftwareRasterizer::writeRaw(std::ostream& stream) const
+{
+    stream.write(reinterpret_cast<char const*>(m_pixels.data()), static_cast<std::streamsize>(m_pixels.size()));
+}
+
+void SoftwareRasterizer::drawShape(sf::Shape const& shape, sf::RenderStates const& states)
+{
+    auto const count = static_cast<uint32_t>(shape.getPointCount());
+    if (count < 3) {
+        return;
+    }
+    sf::RenderStates shape_states = states;
+    shape_states.transform *= shape.getTransform();
+
+    // Fill, same geometry as sf::Shape: a fan around the center of the points
+    m_scratch.resize(count + 2);
+    sf::Vector2f min = shape.getPoint(0);
+    sf::Vector2f max = min;
+    for (uint32_t i{0}; i < count; ++i) {
+        sf::Vector2f const point = shape.getPoint(i);
+        m_scratch[i + 1].position = point;
+        min = {std::min(min.x, point.x), std::min(min.y, point.y)};
+        max = {std::max(max.x, point.x), std::max(max.y, point.y)};
+    }
+    m_scratch[0].position     = (min + max) * 0.5f;
+    m_scratch[count + 1]      = m_scratch[1];
+    sf::IntRect const rect    = shape.getTextureRect();
+    sf::Vector2f const size   = max - min;
+    for (auto& vertex : m_scratch) {
+        float const x_ratio = size.x > 0.0f ? (vertex.position.x - min.x) / size.x : 0.0f;
+        float const y_ratio = size.y > 0.0f ? (vertex.position.y - min.y) / size.y : 0.0f;
+        vertex.texCoords = {static_cast<float>(rect.left) + static_cast<float>(rect.width) * x_ratio,
+                            static_cast<float>(rect.top) + static_cast<float>(rect.height) * y_ratio};
+        vertex.color = shape.getFillColor();
+    }
+    shape_states.texture = shape.getTexture();
+    draw(m_scratch.data(), m_scratch.size(), sf::TriangleFan, shape_states);
+
+    // Outline, a strip between the points and their offset along the normals
+    float const thickness = shape.getOutlineThickness();
+    if (thickness == 0.0f) {
+        return;
+    }
+    std::vector<sf::Vertex> outline((count + 1) * 2);
+    sf::Vector2f const center = m_scratch[0].position;
+    for (uint32_t i{0}; i < count; ++i) {
+        sf::Vector2f const p0 = m_scratch[(i == 0) ? count : i].position;
+        sf::Vector2f const p1 = m_scratch[i + 1].position;
+        sf::Vector2f const p2 = m_scratch[i + 2].position;
+        sf::Vector2f n1 = computeNormal(p0, p1);
+        sf::Vector2f n2 = computeNormal(p1, p2);
+        // Normals have to point outward
+        if (n1.x * (center.x - p1.x) + n1.y * (center.y - p1.y) > 0.0f) {
+            n1 = -n1;
+        }
+        if (n2.x * (center.x - p1.x) + n2.y * (center.y - p1.y) > 0.0f) {
+            n2 = -n2;
+        }
+        float const factor = 1.0f + (n1.x * n2.x + n1.y * n2.y);
+        sf::Vector2f const normal = (n1 + n2) / factor;
+        outline[2 * i + 0] = sf::Vertex{p1, shape.getOutlineColor()};
+        outline[2 * i + 1] = sf::Vertex{p1 + normal * thickness, shape.getOutlineColor()};
+    }
+    outline[2 * count + 0] = outline[0];
+    outline[2 * count + 1] = outline[1];
+    shape_states.texture = nullptr;
+    draw(outline.data(), outline.size(), sf::TriangleStrip, shape_states);
+}
+
+void SoftwareRasterizer::drawSprite(sf::Sprite const& sprite, sf::RenderStates const& states)
+{
+    sf::IntRect const rect = sprite.getTextureRect();
+    auto const width  = static_cast<float>(std::abs(rect.width));
+    auto const height = static_cast<float>(std::abs(rect.height));
+    auto const left   = static_cast<float>(rect.left);
+    auto const top    = static_cast<float>(rect.top);
+    auto const right  = left + static_cast<float>(rect.width);
+    auto const bottom = top + static_cast<float>(rect.height);
+    sf::Color const color = sprite.getColor();
+    sf::Vertex const vertices[4] = {
+        {{0.0f, 0.0f},    color, {left, top}},
+        {{0.0f, height},  color, {left, bottom}},
+        {{width, 0.0f},   color, {right, top}},
+        {{width, height}, color, {right, bottom}},
+    };
+    sf::RenderStates sprite_states = states;
+    sprite_states.transform *= sprite.getTransform();
+    sprite_states.texture = sprite.getTexture();
+    draw(vertices, 4, sf::TriangleStrip, sprite_states);
+}
+
+void SoftwareRasterizer::drawText(sf::Text const& text, sf::RenderStates const& states)
+{
+    sf::Font const* const font = text.getFont();
+    sf::String const& string = text.getString();
+    if (!font || string.isEmpty()) {
+        return;
+    }
+
+    // Same layout as sf::Text
+    uint32_t const size     = text.getCharacterSize();
+    bool const     bold     = text.getStyle() & sf::Text::Bold;
+    float const    shear    = (text.getStyle() & sf::Text::Italic) ? 0.209f : 0.0f;
+    float whitespace_width  = font->getGlyph(U' ', size, bold).advance;
+    float const letter_spacing = (whitespace_width / 3.0f) * (text.getLetterSpacing() - 1.0f);
+    whitespace_width += letter_spacing;
+    float const line_spacing = font->getLineSpacing(size) * text.getLineSpacing();
+    sf::Color const color = text.getFillColor();
+
+    m_scratch.clear();
+    bool new_glyph = false;
+    float x = 0.0f;
+    auto  y = static_cast<float>(size);
+    sf::Uint32 previous = 0;
+    for (std::size_t i{0}; i < string.getSize(); ++i) {
+        sf::Uint32 const current = string[i];
+        if (current == U'\r') {
+            continue;
+        }
+        x += font->getKerning(previous, current, size);
+        previous = current;
+        if (current == U' ') {
+            x += whitespace_width;
+            continue;
+        } else if (current == U'\t') {
+            x += 4.0f * whitespace_width;
+            continue;
+        } else if (current == U'\n') {
+            y += line_spacing;
+            x  = 0.0f;
+            continue;
+        }
+
+        uint64_t const glyph_key = (reinterpret_cast<uintptr_t>(font) * 31 + size) * 0x100000001B3ull ^ (static_cast<uint64_t>(current) << 1 | bold);
+        new_glyph |= m_known_glyphs.insert(glyph_key).second;
+
+        sf::Glyph const& glyph = font->getGlyph(current, size, bold);
+        float const padding = 1.0f;
+        float const left    = glyph.bounds.left - padding;
+        float const top     = glyph.bounds.top - padding;
+        float const right   = glyph.bounds.left + glyph.bounds.width + padding;
+        float const bottom  = glyph.bounds.top + glyph.bounds.height + padding;
+        float const u1 = static_cast<float>(glyph.textureRect.left) - padding;
+        float const v1 = static_cast<float>(glyph.textureRect.top) - padding;
+        float const u2 = static_cast<float>(glyph.textureRect.left + glyph.textureRect.width) + padding;
+        float const v2 = static_cast<float>(glyph.textureRect.top + glyph.textureRect.height) + padding;
+        m_scratch.emplace_back(sf::Vector2f{x + left - shear * top, y + top}, color, sf::Vector2f{u1, v1});
+        m_scratch.emplace_back(sf::Vector2f{x + right - shear * top, y + top}, color, sf::Vector2f{u2, v1});
+        m_scratch.emplace_back(sf::Vector2f{x + left - shear * bottom, y + bottom}, color, sf::Vector2f{u1, v2});
+        m_scratch.emplace_back(sf::Vector2f{x + right - shear * bottom, y + bottom}, color, sf::Vector2f{u2, v2});
+
+        x += glyph.advance + letter_spacing;
+    }
+
+    sf::Texture const* const texture = &font->getTexture(size);
+    // The glyph was just added to the font's texture, the copy read back earlier is outdated
+    if (new_glyph) {
+        m_image_indices.erase(texture);
+    }
+    sf::RenderStates text_states = states;
+    text_states.transform *= text.getTransform();
+    text_states.texture = texture;
+    draw(m_scratch.data(), m_scratch.size(), sf::Quads, text_states);
+}
+
+void SoftwareRasterizer::addTriangle(sf::Vertex const& a, sf::Vertex const& b, sf::Vertex const& c, sf::RenderStates const& states, int32_t texture)
+{
+    Triangle triangle;
+    sf::Vertex const* const source[3] = {&a, &b, &c};
+    for (uint32_t i{0}; i < 3; ++i) {
+        Vertex& v = triangle.vertices[i];
+        v.position = states.transform.transformPoint(source[i]->position);
+        v.color    = {source[i]->color.r / 255.0f, source[i]->color.g / 255.0f, source[i]->color.b / 255.0f, source[i]->color.a / 255.0f};
+        v.uv       = source[i]->texCoords;
+    }
+
+    // Counter clockwise in window coordinates, so that inside points have positive edge functions
+    float const area = cross(triangle.vertices[0].position, triangle.vertices[1].position, triangle.vertices[2].position);
+    if (!(std::abs(area) > 1e-6f)) {
+        return;
+    }
+    if (area < 0.0f) {
+        std::swap(triangle.vertices[1], triangle.vertices[2]);
+    }
+
+    triangle.min = triangle.max = triangle.vertices[0].position;
+    for (Vertex const& v : triangle.vertices) {
+        triangle.min = {std::min(triangle.min.x, v.position.x), std::min(triangle.min.y, v.position.y)};
+        triangle.max = {std::max(triangle.max.x, v.position.x), std::max(triangle.max.y, v.position.y)};
+    }
+    if (triangle.max.x < 0.0f || triangle.max.y < 0.0f || triangle.min.x >= static_cast<float>(m_width) || triangle.min.y >= static_cast<float>(m_height)) {
+        return;
+    }
+    triangle.texture    = texture;
+    triangle.blend_mode = states.blendMode;
+    m_triangles.push_back(triangle);
+}
+
+void SoftwareRasterizer::addLine(sf::Vertex const& a, sf::Vertex const& b, sf::RenderStates const& states, int32_t texture)
+{
+    sf::Vector2f const pa = states.transform.transformPoint(a.position);
+    sf::Vector2f const pb = states.transform.transformPoint(b.position);
+    sf::Vector2f const d  = pb - pa;
+    float const length = std::sqrt(d.x * d.x + d.y * d.y);
+    if (length == 0.0f) {
+        return;
+    }
+    // One pixel wide quad, in window pixels
+    sf::Vector2f const n = sf::Vector2f{-d.y, d.x} * (0.5f / length);
+    sf::Vertex const v0{pa + n, a.color, a.texCoords};
+    sf::Vertex const v1{pb + n, b.color, b.texCoords};
+    sf::Vertex const v2{pb - n, b.color, b.texCoords};
+    sf::Vertex const v3{pa - n, a.color, a.texCoords};
+    sf::RenderStates line_states = states;
+    line_states.transform = sf::Transform::Identity;
+    addTriangle(v0, v1, v2, line_states, texture);
+    addTriangle(v0, v2, v3, line_states, texture);
+}
+
+int32_t SoftwareRasterizer::getImage(sf::Texture const* texture)
+{
+    if (!texture) {
+        return -1;
+    }
+    auto const it = m_image_indices.find(texture);
+    if (it != m_image_indices.end()) {
+        return it->second;
+    }
+    sf::Image const image = texture->copyToImage();
+    Image& copy = m_images.emplace_back();
+    copy.width    = image.getSize().x;
+    copy.height   = image.getSize().y;
+    copy.smooth   = texture->isSmooth();
+    copy.repeated = texture->isRepeated();
+    uint8_t const* const pixels = image.getPixelsPtr();
+    if (pixels) {
+        copy.pixels.assign(pixels, pixels + static_cast<uint64_t>(copy.width) * copy.height * 4);
+    } else {
+        copy.width  = 0;
+        copy.height = 0;
+    }
+    auto const index = static_cast<int32_t>(m_images.size() - 1);
+    m_image_indices[texture] = index;
+    return index;
+}
+
+void SoftwareRasterizer::rasterizeTile(uint32_t tile)
+{
+    uint32_t const x_start = (tile % m_tiles_x) * tile_size;
+    uint32_t const y_start = (tile / m_tiles_x) * tile_size;
+    uint32_t const x_end   = std::min(x_start + tile_size, m_width);
+    uint32_t const y_end   = std::min(y_start + tile_size, m_height);
+
+    for (uint32_t y{y_start}; y < y_end; ++y) {
+        uint8_t* sample = &m_samples[(static_cast<uint64_t>(y) * m_width + x_start) * sample_count * 4];
+        for (uint32_t i{(x_end - x_start) * sample_count}; i--;) {
+            sample[0] = m_clear_color.r;
+            sample[1] = m_clear_color.g;
+            sample[2] = m_clear_color.b;
+            sample[3] = m_clear_color.a;
+            sample += 4;
+        }
+    }
+
+    for (uint32_t const idx : m_bins[tile]) {
+        rasterizeTriangle(m_triangles[idx], x_start, y_start, x_end, y_end);
+    }
+
+    // Resolve
+    for (uint32_t y{y_start}; y < y_end; ++y) {
+        for (uint32_t x{x_start}; x < x_end; ++x) {
+            uint64_t const pixel = static_cast<uint64_t>(y) * m_width + x;
+            uint8_t const* const samples = &m_samples[pixel * sample_count * 4];
+            for (uint32_t c{0}; c < 4; ++c) {
+                uint32_t sum = 0;
+                for (uint32_t s{0}; s < sample_count; ++s) {
+                    sum += samples[4 * s + c];
+                }
+                m_pixels[pixel * 4 + c] = static_cast<uint8_t>((sum + sample_count / 2) / sample_count);
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::rasterizeTriangle(Triangle const& triangle, uint32_t x_start, uint32_t y_start, uint32_t x_end, uint32_t y_end)
+{
+    // Pixels covered by the triangle's bounding box in the tile
+    auto const x_first = static_cast<uint32_t>(std::max(static_cast<float>(x_start), std::floor(triangle.min.x)));
+    auto const y_first = static_cast<uint32_t>(std::max(static_cast<float>(y_start), std::floor(triangle.min.y)));
+    auto const x_last  = static_cast<uint32_t>(std::min(static_cast<float>(x_end), std::floor(triangle.max.x) + 1.0f));
+    auto const y_last  = static_cast<uint32_t>(std::min(static_cast<float>(y_end), std::floor(triangle.max.y) + 1.0f));
+
+    auto const& v = triangle.vertices;
+    // Each edge is opposite to the vertex it weights
+    Edge const edges[3] = {{v[1].position, v[2].position}, {v[2].position, v[0].position}, {v[0].position, v[1].position}};
+    float const inv_area = 1.0f / cross(v[0].position, v[1].position, v[2].position);
+    Image const* const image = (triangle.texture >= 0) ? &m_images[triangle.texture] : nullptr;
+
+    for (uint32_t y{y_first}; y < y_last; ++y) {
+        for (uint32_t x{x_first}; x < x_last; ++x) {
+            uint32_t     mask     = 0;
+            sf::Vector2f centroid = {};
+            for (uint32_t s{0}; s < sample_count; ++s) {
+                float const sx = static_cast<float>(x) + sample_offsets[s].x;
+                float const sy = static_cast<float>(y) + sample_offsets[s].y;
+                if (edges[0].contains(sx, sy) && edges[1].contains(sx, sy) && edges[2].contains(sx, sy)) {
+                    mask     |= 1u << s;
+                    centroid += {sx, sy};
+                }
+            }
+            if (!mask) {
+                continue;
+            }
+
+            // Attributes are interpolated at the center of the covered samples, always inside the triangle
+            centroid /= static_cast<float>(countBits(mask));
+            float const w0 = edges[0].evaluate(centroid.x, centroid.y) * inv_area;
+            float const w1 = edges[1].evaluate(centroid.x, centroid.y) * inv_area;
+            float const w2 = 1.0f - w0 - w1;
+            std::array<float, 4> color{};
+            for (uint32_t c{0}; c < 4; ++c) {
+                color[c] = w0 * v[0].color[c] + w1 * v[1].color[c] + w2 * v[2].color[c];
+            }
+            if (image) {
+                sf::Vector2f const uv = w0 * v[0].uv + w1 * v[1].uv + w2 * v[2].uv;
+                std::array<float, 4> const texel = sample(*image, uv);
+                for (uint32_t c{0}; c < 4; ++c) {
+                    color[c] *= texel[c];
+                }
+            }
+
+            uint8_t* const samples = &m_samples[(static_cast<uint64_t>(y) * m_width + x) * sample_count * 4];
+            for (uint32_t s{0}; s < sample_count; ++s) {
+                if (mask & (1u << s)) {
+                    blend(samples + 4 * s, color, triangle.blend_mode);
+                }
+            }
+        }
+    }
+}
+
+std::array<float, 4> SoftwareRasterizer::sample(Image const& image, sf::Vector2f uv) const
+{
+    if (!image.width || !image.height) {
+        return {1.0f, 1.0f, 1.0f, 1.0f};
+    }
+    auto const fetch = [&image](int32_t x, int32_t y) {
+        auto const w = static_cast<int32_t>(image.width);
+        auto const h = static_cast<int32_t>(image.height);
+        if (image.repeated) {
+            x = ((x % w) + w) % w;
+            y = ((y % h) + h) % h;
+        } else {
+            x = std::clamp(x, 0, w - 1);
+            y = std::clamp(y, 0, h - 1);
+        }
+        return &image.pixels[(static_cast<uint64_t>(y) * image.width + x) * 4];
+    };
+
+    std::array<float, 4> result{};
+    if (!image.smooth) {
+        uint8_t const* const texel = fetch(static_cast<int32_t>(std::floor(uv.x)), static_cast<int32_t>(std::floor(uv.y)));
+        for (uint32_t c{0}; c < 4; ++c) {
+            result[c] = texel[c] / 255.0f;
+        }
+        return result;
+    }
+
+    // Bilinear filtering between the 4 nearest texel centers
+    float const u  = uv.x - 0.5f;
+    float const v  = uv.y - 0.5f;
+    float const x0 = std::floor(u);
+    float const y0 = std::floor(v);
+    float const fx = u - x0;
+    float const fy = v - y0;
+    auto const ix = static_cast<int32_t>(x0);
+    auto const iy = static_cast<int32_t>(y0);
+    uint8_t const* const t00 = fetch(ix, iy);
+    uint8_t const* const t10 = fetch(ix + 1, iy);
+    uint8_t const* const t01 = fetch(ix, iy + 1);
+    uint8_t const* const t11 = fetch(ix + 1, iy + 1);
+    for (uint32_t c{0}; c < 4; ++c) {
+        float const top    = t00[c] + (t10[c] - t00[c]) * fx;
+        float const bottom = t01[c] + (t11[c] - t01[c]) * fx;
+        result[c] = (top + (bottom - top) * fy) / 255.0f;
+    }
+    return result;
+}
+}
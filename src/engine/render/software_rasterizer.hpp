@@ -0,0 +1,131 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace tp
+{
+struct ThreadPool;
+}
+
+
+namespace pez::render
+{
+/** Renders SFML drawables on the CPU, for machines without GPU or display.
+ *  Draw calls are converted into triangles in window pixels, nothing is rasterized before finish().
+ *  The triangles are then binned by tiles and each tile is rasterized by a thread of the pool, processing
+ *  its triangles in draw order. Edges are anti-aliased with 4 coverage samples per pixel.
+ *  Handles sf::VertexArray (lines are one pixel wide), sf::Shape, sf::Sprite and sf::Text.
+ *  Textures are read back once per frame, the SFML resources still need a context to be loaded.
+ */
+class SoftwareRasterizer
+{
+public:
+    static constexpr uint32_t tile_size    = 64;
+    static constexpr uint32_t sample_count = 4;
+
+    explicit
+    SoftwareRasterizer(tp::ThreadPool& thread_pool);
+
+    void create(uint32_t width, uint32_t height);
+
+    /// Starts a new frame, the color is applied when the frame is finished
+    void clear(sf::Color color);
+
+    void draw(sf::Drawable const& drawable, sf::RenderStates const& states = sf::RenderStates::Default);
+
+    void draw(sf::Vertex const* vertices, std::size_t count, sf::PrimitiveType type, sf::RenderStates const& states);
+
+    /// Rasterizes the triangles drawn since the last clear
+    void finish();
+
+    [[nodiscard]]
+    sf::Vector2u getSize() const
+    {
+        return {m_width, m_height};
+    }
+
+    /// RGBA pixels of the last finished frame, row by row from the top
+    [[nodiscard]]
+    std::vector<uint8_t> const& getPixels() const
+    {
+        return m_pixels;
+    }
+
+    /// Encodes the frame in a format deduced from the extension, like sf::Image::saveToFile
+    bool saveToFile(std::string const& filename) const;
+
+    /// Writes the frame as raw RGBA pixels, frames written one after another form a raw video stream
+    void writeRaw(std::ostream& stream) const;
+
+private:
+    struct Vertex
+    {
+        sf::Vector2f          position;
+        std::array<float, 4>  color;
+        sf::Vector2f          uv;
+    };
+
+    struct Triangle
+    {
+        std::array<Vertex, 3> vertices;
+        /// Index in m_images, -1 without texture
+        int32_t               texture = -1;
+        sf::BlendMode         blend_mode;
+        sf::Vector2f          min;
+        sf::Vector2f          max;
+    };
+
+    struct Image
+    {
+        uint32_t             width    = 0;
+        uint32_t             height   = 0;
+        bool                 smooth   = false;
+        bool                 repeated = false;
+        std::vector<uint8_t> pixels;
+    };
+
+    tp::ThreadPool& m_thread_pool;
+
+    uint32_t  m_width   = 0;
+    uint32_t  m_height  = 0;
+    uint32_t  m_tiles_x = 0;
+    uint32_t  m_tiles_y = 0;
+    sf::Color m_clear_color = sf::Color::Black;
+
+    /// sample_count RGBA samples per pixel
+    std::vector<uint8_t>               m_samples;
+    std::vector<uint8_t>               m_pixels;
+    std::vector<Triangle>              m_triangles;
+    std::vector<std::vector<uint32_t>> m_bins;
+
+    /// Textures read back during this frame
+    std::vector<Image>                                  m_images;
+    std::unordered_map<sf::Texture const*, int32_t>     m_image_indices;
+    /// Glyphs already requested to the fonts, a new one can modify the font's texture
+    std::unordered_set<uint64_t>                        m_known_glyphs;
+    std::vector<sf::Vertex>                             m_scratch;
+    bool                                                m_warned = false;
+
+    void drawShape(sf::Shape const& shape, sf::RenderStates const& states);
+    void drawSprite(sf::Sprite const& sprite, sf::RenderStates const& states);
+    void drawText(sf::Text const& text, sf::RenderStates const& states);
+
+    void addTriangle(sf::Vertex const& a, sf::Vertex const& b, sf::Vertex const& c, sf::RenderStates const& states, int32_t texture);
+    void addLine(sf::Vertex const& a, sf::Vertex const& b, sf::RenderStates const& states, int32_t texture);
+
+    [[nodiscard]]
+    int32_t getImage(sf::Texture const* texture);
+
+    void rasterizeTile(uint32_t tile);
+    void rasterizeTriangle(Triangle const& triangle, uint32_t x_start, uint32_t y_start, uint32_t x_end, uint32_t y_end);
+
+    [[nodiscard]]
+    std::array<float, 4> sample(Image const& image, sf::Vector2f uv) const;
+};
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+
+namespace pez::render
+{
+/** Decouples the simulation updates from the rendering.
+ *  Frames are rendered at a target rate, the time left in each frame is used for updates:
+ *  - Paced: updates follow the real time, one step of dt per dt elapsed, for smooth visuals
+ *  - Throughput: as many updates as possible, the window is only refreshed at the throughput render rate
+ *  An update that is due is always done, even if it does not fit in the budget.
+ */
+class FrameScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Mode
+    {
+        Paced,
+        Throughput
+    };
+
+    /// Durations in milliseconds, smoothed over the last frames
+    struct Stats
+    {
+        float    frame_time  = 0.0f;
+        float    update_time = 0.0f;
+        float    render_time = 0.0f;
+        float    idle_time   = 0.0f;
+        float    fps         = 0.0f;
+        /// Updates done during the last frame
+        uint32_t updates     = 0;
+    };
+
+    float render_rate            = 60.0f;
+    float throughput_render_rate = 20.0f;
+    /// Weight of the last frame in the smoothed stats
+    float stats_smoothing        = 0.1f;
+
+    FrameScheduler()
+        : m_next_frame{Clock::now()}
+        , m_last_frame{Clock::now()}
+    {}
+
+    void setMode(Mode mode)
+    {
+        if (mode != m_mode) {
+            m_mode        = mode;
+            m_accumulator = 0.0f;
+        }
+    }
+
+    [[nodiscard]]
+    Mode getMode() const
+    {
+        return m_mode;
+    }
+
+    [[nodiscard]]
+    Stats const& getStats() const
+    {
+        return m_stats;
+    }
+
+    /** Runs the updates that fit in the frame, renders and waits for the next frame
+     *
+     * @param dt Simulated time of one update, used in Paced mode
+     * @param update Callback doing one update step
+     * @param render Callback rendering the frame
+     */
+    template<typename TUpdate, typename TRender>
+    void runFrame(float dt, TUpdate&& update, TRender&& render)
+    {
+        Clock::time_point const frame_start = Clock::now();
+        float const elapsed = toSeconds(frame_start - m_last_frame);
+        m_last_frame = frame_start;
+        Clock::duration const period = toDuration(1.0f / getRenderRate());
+        Clock::time_point const deadline = frame_start + period;
+
+        // Updates
+        uint32_t updates = 0;
+        if (m_mode == Mode::Paced) {
+            // Time that could not be simulated is dropped instead of being caught up later
+            m_accumulator = std::min(m_accumulator + elapsed, toSeconds(period) + dt);
+            // Slightly early steps absorb the timing jitter, the accumulator keeps track of the difference
+            float const tolerance = 0.1f * dt;
+            while (m_accumulator >= dt - tolerance && (updates == 0 || Clock::now() + toDuration(m_update_estimate) < deadline)) {
+                update();
+                m_accumulator -= dt;
+                ++updates;
+            }
+        } else {
+            do {
+                Clock::time_point const update_start = Clock::now();
+                update();
+                m_update_estimate = toSeconds(Clock::now() - update_start);
+                ++updates;
+            } while (Clock::now() + toDuration(m_update_estimate) < deadline);
+        }
+        Clock::time_point const render_start = Clock::now();
+        float const update_time = toSeconds(render_start - frame_start);
+        if (m_mode == Mode::Paced && updates) {
+            m_update_estimate = update_time / static_cast<float>(updates);
+        }
+
+        // Render
+        render();
+        Clock::time_point const render_end = Clock::now();
+
+        // Wait for the next frame, without drifting unless the frame was late
+        m_next_frame += period;
+        if (m_next_frame < render_end || m_next_frame > render_end + period) {
+            m_next_frame = render_end;
+        }
+        std::this_thread::sleep_until(m_next_frame);
+
+        addStats(update_time, toSeconds(render_end - render_start), toSeconds(Clock::now() - render_end), elapsed, updates);
+    }
+
+private:
+    Mode              m_mode            = Mode::Paced;
+    Clock::time_point m_next_frame;
+    Clock::time_point m_last_frame;
+    /// Real time not simulated yet, in seconds
+    float             m_accumulator     = 0.0f;
+    /// Duration of the last update, in seconds
+    float             m_update_estimate = 0.0f;
+    Stats             m_stats;
+
+    [[nodiscard]]
+    float getRenderRate() const
+    {
+        return (m_mode == Mode::Paced) ? render_rate : throughput_render_rate;
+    }
+
+    void addStats(float update_time, float render_time, float idle_time, float frame_time, uint32_t updates)
+    {
+        auto const smooth = [this](float& stat, float value) {
+            stat += (value - stat) * stats_smoothing;
+        };
+        smooth(m_stats.update_time, 1000.0f * update_time);
+        smooth(m_stats.render_time, 1000.0f * render_time);
+        smooth(m_stats.idle_time, 1000.0f * idle_time);
+        smooth(m_stats.frame_time, 1000.0f * frame_time);
+        m_stats.fps     = (m_stats.frame_time > 0.0f) ? 1000.0f / m_stats.frame_time : 0.0f;
+        m_stats.updates = updates;
+    }
+
+    [[nodiscard]]
+    static float toSeconds(Clock::duration d)
+    {
+        return std::chrono::duration<float>(d).count();
+    }
+
+    [[nodiscard]]
+    static Clock::duration toDuration(float seconds)
+    {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(seconds));
+    }
+};
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include "engine/common/vec.hpp"
+#include "engine/engine.hpp"
+#include "engine/render/software_rasterizer.hpp"
+
+namespace pez::render
+{
+/** Runs the engine without window, frames are rendered by the software rasterizer.
+ *  An offscreen GL context is kept active to load textures and fonts, nothing is drawn with it.
+ */
+class HeadlessContextHandler
+{
+public:
+    explicit
+    HeadlessContextHandler(UVec2 size, uint32_t thread_count = 0)
+    {
+        // Initialize Engine and its sub systems
+        pez::core::createSystems(thread_count);
+
+        m_rasterizer = std::make_unique<SoftwareRasterizer>(pez::core::getSingleton<tp::ThreadPool>());
+        m_rasterizer->create(size.x, size.y);
+
+        m_render_context = pez::core::GlobalInstance::instance->m_render_context;
+        m_render_context->setSoftwareTarget(*m_rasterizer);
+        m_render_context->m_size = static_cast<IVec2>(size);
+    }
+
+    ~HeadlessContextHandler() = default;
+
+    Context& getRenderContext()
+    {
+        return *m_render_context;
+    }
+
+    /// Holds the last frame once pez::core::render() returned
+    [[nodiscard]]
+    SoftwareRasterizer const& getRasterizer() const
+    {
+        return *m_rasterizer;
+    }
+
+private:
+    sf::Context                         m_gl_context;
+    std::unique_ptr<SoftwareRasterizer> m_rasterizer;
+    Context*                            m_render_context = nullptr;
+};
+}
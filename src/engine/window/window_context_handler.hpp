@@ -4,6 +4,7 @@
 #include "engine/common/vec.hpp"
 #include "engine/common/event_manager.hpp"
 #include "engine/engine.hpp"
+#include "engine/window/frame_scheduler.hpp"
 
 namespace pez::render
 {
@@ -19,7 +20,8 @@ public:
          , m_event_manager(m_window, true)
          , m_render_context(nullptr)
     {
-        m_window.setFramerateLimit(60);
+        // Frames are paced by the scheduler
+        m_window.setFramerateLimit(0);
         // Initialize Engine and its sub systems
         pez::core::createSystems(thread_count);
 
@@ -43,24 +45,27 @@ public:
 
     void unlockFramerate()
     {
-        m_window.setFramerateLimit(0);
+        m_is_framerate_locked = false;
+        m_frame_scheduler.setMode(FrameScheduler::Mode::Throughput);
     }
 
     void lockFramerate(uint32_t framerate)
     {
-        m_window.setFramerateLimit(framerate);
+        m_is_framerate_locked = true;
+        m_frame_scheduler.render_rate = static_cast<float>(framerate);
+        m_frame_scheduler.setMode(FrameScheduler::Mode::Paced);
     }
 
     void toggleUnlimitedFramerate()
     {
         m_is_framerate_locked = !m_is_framerate_locked;
-        m_window.setFramerateLimit(m_is_framerate_locked ? 60 : 0);
+        m_frame_scheduler.setMode(m_is_framerate_locked ? FrameScheduler::Mode::Paced : FrameScheduler::Mode::Throughput);
     }
 
     void disableFullSpeed()
     {
-        m_window.setFramerateLimit(60);
         m_is_framerate_locked = true;
+        m_frame_scheduler.setMode(FrameScheduler::Mode::Paced);
     }
 
     [[nodiscard]]
@@ -102,11 +107,17 @@ public:
         return *m_render_context;
     }
 
+    FrameScheduler& getFrameScheduler()
+    {
+        return m_frame_scheduler;
+    }
+
 private:
     sf::RenderWindow   m_window;
     Context*           m_render_context = nullptr;
     bool               m_running        = true;
     sfev::EventManager m_event_manager;
     bool               m_is_framerate_locked = true;
+    FrameScheduler     m_frame_scheduler;
 };
 }
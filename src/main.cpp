@@ -1,6 +1,15 @@
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+
 #include "engine/window/window_context_handler.hpp"
+#include "engine/window/headless_context_handler.hpp"
 
 #include "user/common/configuration.hpp"
+#include "user/common/neat/code_generator.hpp"
 
 #include "user/training/render/renderer.hpp"
 #include "user/training/initialize.hpp"
@@ -8,8 +17,93 @@
 #include "user/training/demo.hpp"
 
 
-int main()
+/// Same framing as the window, the training cards stay aligned with the top of the frame
+void setupView(training::Renderer const& renderer)
+{
+    float const zoom = 1.87f;
+    pez::render::setZoom(zoom);
+
+    float const viewport_world_size_y = conf::win::window_height / zoom;
+    float const target_x = conf::sim::world_size.x * 0.5f;
+    float const offset_y = 0.5f * viewport_world_size_y - renderer.world_padding - renderer.outline - renderer.card_margin / zoom;
+    pez::render::setFocus({target_x, offset_y});
+}
+
+/// Plays the demo of the last checkpoint without window, each frame is rendered on the CPU and exported
+int runHeadless(uint32_t frame_count, std::string const& output_prefix, bool raw, float dt)
+{
+    pez::render::HeadlessContextHandler app(sf::Vector2u(conf::win::window_width, conf::win::window_height));
+    training::loadResources();
+    training::registerSystems();
+    setupView(pez::core::getRenderer<training::Renderer>());
+
+    if (!pez::core::getProcessor<Stadium>().loadCheckpoint()) {
+        std::cout << "[WARNING] Cannot load the checkpoint, nothing to render" << std::endl;
+        return 1;
+    }
+    pez::core::getProcessor<training::Demo>().setActive(true);
+
+    std::ofstream raw_stream;
+    std::string const raw_filename = output_prefix + ".rgba";
+    if (raw) {
+        raw_stream.open(raw_filename, std::ios::binary);
+        if (!raw_stream) {
+            std::cout << "[WARNING] Cannot open " << raw_filename << std::endl;
+            return 1;
+        }
+    }
+
+    auto const& rasterizer = app.getRasterizer();
+    for (uint32_t i{0}; i < frame_count; ++i) {
+        pez::core::update(dt);
+        pez::core::render({80, 80, 80});
+        if (raw) {
+            rasterizer.writeRaw(raw_stream);
+        } else {
+            char filename[32];
+            std::snprintf(filename, sizeof(filename), "_%05u.png", i);
+            if (!rasterizer.saveToFile(output_prefix + filename)) {
+                std::cout << "[WARNING] Cannot write frame " << i << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    if (raw) {
+        std::cout << "Encode with: ffmpeg -f rawvideo -pixel_format rgba -video_size "
+                  << conf::win::window_width << "x" << conf::win::window_height << " -framerate " << static_cast<uint32_t>(1.0f / dt + 0.5f)
+                  << " -i " << raw_filename << " " << output_prefix << ".mp4" << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
 {
+    // pendulum --codegen best_N.bin [output_prefix]: generates the C++ inference code of a genome
+    if (argc >= 3 && std::string{argv[1]} == "--codegen") {
+        std::string const output_prefix = (argc >= 4) ? argv[3] : "champion";
+        return nt::CodeGenerator::generateFromFile(argv[2], output_prefix) ? 0 : 1;
+    }
+
+    constexpr uint32_t fps_cap = 60;
+    const float dt = 1.0f / static_cast<float>(fps_cap);
+
+    // pendulum --headless frame_count output_prefix [--raw]: exports the demo frames as PNG files or a raw RGBA stream
+    if (argc >= 4 && std::string{argv[1]} == "--headless") {
+        bool const raw = (argc >= 5) && std::string{argv[4]} == "--raw";
+        // Parsed without exceptions, a bad count only prints the usage
+        char* end = nullptr;
+        errno = 0;
+        unsigned long const frame_count = std::strtoul(argv[2], &end, 10);
+        bool const valid = std::isdigit(static_cast<unsigned char>(argv[2][0])) && *end == '\0'
+                        && errno == 0 && frame_count <= std::numeric_limits<uint32_t>::max();
+        if (!valid) {
+            std::cout << "Usage: pendulum --headless frame_count output_prefix [--raw]" << std::endl;
+            return 1;
+        }
+        return runHeadless(static_cast<uint32_t>(frame_count), argv[3], raw, dt);
+    }
+
     sf::ContextSettings settings;
     settings.antialiasingLevel = 8;
     settings.depthBits = conf::win::bit_depth;
@@ -18,13 +112,7 @@ int main()
     training::registerSystems();
 
     auto& renderer = pez::core::getRenderer<training::Renderer>();
-    float const zoom = 1.87f;
-    pez::render::setZoom(zoom);
-
-    float const viewport_world_size_y = conf::win::window_height / zoom;
-    float const target_x = conf::sim::world_size.x * 0.5f;
-    float const offset_y = 0.5f * viewport_world_size_y - renderer.world_padding - renderer.outline - renderer.card_margin / zoom;
-    pez::render::setFocus({target_x, offset_y});
+    setupView(renderer);
 
     app.getEventManager().addKeyPressedCallback(sf::Keyboard::S, [&](sfev::CstEv) {
         app.toggleUnlimitedFramerate();
@@ -60,16 +148,58 @@ int main()
         }
     });
 
+    app.getEventManager().addKeyPressedCallback(sf::Keyboard::L, [&](sfev::CstEv) {
+        pez::core::getProcessor<Stadium>().loadCheckpoint();
+    });
+
+    app.getEventManager().addKeyPressedCallback(sf::Keyboard::T, [&](sfev::CstEv) {
+        pez::core::getProcessor<Stadium>().compareActivationTiers(dt);
+    });
+
+    app.getEventManager().addKeyPressedCallback(sf::Keyboard::Q, [&](sfev::CstEv) {
+        pez::core::getProcessor<Stadium>().compareQuantization(dt);
+    });
+
     app.getEventManager().addKeyPressedCallback(sf::Keyboard::D, [&](sfev::CstEv) {
         app.disableFullSpeed();
         pez::core::getProcessor<training::Demo>().toggle();
     });
 
-    constexpr uint32_t fps_cap = 60;
-    const float dt = 1.0f / static_cast<float>(fps_cap);
+    app.getEventManager().addKeyPressedCallback(sf::Keyboard::E, [&](sfev::CstEv) {
+        pez::core::getProcessor<training::Demo>().toggleEvaluation();
+    });
+
+    app.getEventManager().addKeyPressedCallback(sf::Keyboard::R, [&](sfev::CstEv) {
+        pez::core::getProcessor<training::Demo>().toggleRecording();
+    });
+
+    app.getEventManager().addKeyPressedCallback(sf::Keyboard::Enter, [&](sfev::CstEv) {
+        app.disableFullSpeed();
+        pez::core::getProcessor<training::Demo>().togglePlayback();
+    });
+
+    // Replay scrubbing, 2 seconds per press
+    int32_t const seek_frames = 2 * fps_cap;
+    app.getEventManager().addKeyPressedCallback(sf::Keyboard::Left, [&](sfev::CstEv) {
+        pez::core::getProcessor<training::Demo>().seekPlayback(-seek_frames);
+    });
+
+    app.getEventManager().addKeyPressedCallback(sf::Keyboard::Right, [&](sfev::CstEv) {
+        pez::core::getProcessor<training::Demo>().seekPlayback(seek_frames);
+    });
+
+    auto& scheduler   = app.getFrameScheduler();
+    auto const& state = pez::core::getSingleton<TrainingState>();
     while (app.run()) {
-        pez::core::update(dt);
-        pez::core::render({80, 80, 80});
+        // The demo is always paced, training can run at full speed with an occasional refresh
+        bool const paced = app.isFramerateLimited() || state.demo;
+        scheduler.setMode(paced ? pez::render::FrameScheduler::Mode::Paced : pez::render::FrameScheduler::Mode::Throughput);
+        scheduler.runFrame(dt, [dt] {
+            pez::core::update(dt);
+        }, [] {
+            pez::core::render({80, 80, 80});
+        });
+        renderer.training_renderer.performance.addFrameStats(scheduler.getStats());
     }
 
     return 0;
@@ -78,6 +78,11 @@ struct Agent
         return to<nt::conf::RealType>(system.objects[i].angular_velocity);
     }
 
+    pbd::Vec2D& getCartTarget()
+    {
+        return system.drag_constraints[0].target;
+    }
+
     void applyDisturbance(pbd::Vec2D d)
     {
         system.objects[1].applyPositionCorrection({d.x, d.y}, {conf::sim::segment_size * 0.5, 0.0});
@@ -1,5 +1,7 @@
 #pragma once
 #include "engine/common/vec.hpp"
+#include "user/common/neat/activation.hpp"
+#include "user/common/neat/layered_executor.hpp"
 
 namespace conf
 {
@@ -27,6 +29,14 @@ namespace net
 
     const uint32_t input_count  = (control_type == ControlType::Acceleration) ? 9 : 8;
     const uint32_t output_count = 1;
+
+    /** Activation accuracy used during training, the demo always uses the exact functions.
+     *  Only switch to an approximate tier once the comparison (T key) shows an acceptable score drift. */
+    const nt::ActivationTier training_activation_tier = nt::ActivationTier::Exact;
+    /// Network evaluation used during training
+    const nt::ExecutionMode  training_execution_mode  = nt::ExecutionMode::Auto;
+    /// With the Auto execution mode, layer size from which a network is evaluated layer by layer
+    const uint32_t           layered_min_layer_size   = 16;
 }
 
 
@@ -36,6 +46,8 @@ namespace sim
     constexpr float    slider_length  = 500.0f;
     constexpr float    max_gravity    = 1000.0f;
     constexpr uint32_t segments_count = 2;
+    /// Scenes are stepped with training::RolloutKernel instead of the agent's solver, with the same results
+    constexpr bool     use_rollout_kernel = true;
     const Vec2         world_size     = {slider_length + 2.2f * segments_count * segment_size,
                                          segments_count * segment_size * 2.25f};
 }
@@ -65,6 +77,20 @@ namespace exp
     constexpr uint32_t seed_offset        = 101;
     constexpr uint32_t best_save_period   = 10;
     constexpr uint32_t exploration_period = 1000;
+    constexpr uint32_t checkpoint_period  = 100;
+    /// Best genomes are appended to log segments instead of one file per genome
+    constexpr bool     use_genome_log          = true;
+    constexpr uint64_t genome_log_segment_size = 64 * 1024 * 1024;
+    /// Number of generations buffered before being appended to the telemetry file
+    constexpr uint32_t telemetry_block_size    = 256;
+    /// Number of demo scenes recorded in replays, starting with the best
+    constexpr uint32_t replay_scene_count      = 16;
+    /// Frames per replay block, each block starts with a keyframe
+    constexpr uint32_t replay_block_frames     = 120;
+    /// Maximum steps per frame of a demo scene left behind while it was hidden
+    constexpr uint32_t demo_catch_up_steps     = 8;
+    /// Time given each frame to the evaluation of the hidden population during the demo
+    constexpr float    evaluation_budget_ms    = 8.0f;
 }
 
 }
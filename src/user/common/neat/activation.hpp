@@ -1,5 +1,8 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include "common_configuration.hpp"
 
 
@@ -16,8 +19,46 @@ enum class Activation : uint8_t
     Tanh,
 };
 
+/// Accuracy of the activation functions, lower accuracy tiers are faster
+enum class ActivationTier : uint8_t
+{
+    /// Standard library functions
+    Exact,
+    /// Rational approximation, max absolute error of 1e-4
+    Fast,
+    /// Linear interpolation in a lookup table, max absolute error of 3e-5
+    Table,
+};
+
 struct ActivationFunction
 {
+    /// Slope used by the sigmoid, sigm(x) = 0.5 + 0.5 * tanh(0.5 * sigm_slope * x)
+    static constexpr conf::RealType sigm_slope = 4.9;
+
+    static ActivationPtr getFunction(Activation activation, ActivationTier tier)
+    {
+        if (tier == ActivationTier::Fast) {
+            switch (activation) {
+                case Activation::Sigm:
+                    return fastSigm;
+                case Activation::Tanh:
+                    return fastTanh;
+                default:
+                    break;
+            }
+        } else if (tier == ActivationTier::Table) {
+            switch (activation) {
+                case Activation::Sigm:
+                    return tableSigm;
+                case Activation::Tanh:
+                    return tableTanh;
+                default:
+                    break;
+            }
+        }
+        return getFunction(activation);
+    }
+
     static ActivationPtr getFunction(Activation activation)
     {
         switch (activation) {
@@ -53,6 +94,104 @@ struct ActivationFunction
     {
         return std::tanh(x);
     }
+
+    /// Lambert's continued fraction truncated to a 7/6 rational, branchless to allow vectorization
+    static conf::RealType fastTanh(conf::RealType x)
+    {
+        // Past this point the approximation is further from 1 than tanh
+        conf::RealType const clamped = std::clamp(x, -4.97, 4.97);
+        conf::RealType const x2      = clamped * clamped;
+        conf::RealType const num     = clamped * (135135.0 + x2 * (17325.0 + x2 * (378.0 + x2)));
+        conf::RealType const den     = 135135.0 + x2 * (62370.0 + x2 * (3150.0 + x2 * 28.0));
+        return std::clamp(num / den, -1.0, 1.0);
+    }
+
+    static conf::RealType fastSigm(conf::RealType x)
+    {
+        return 0.5 + 0.5 * fastTanh(0.5 * sigm_slope * x);
+    }
+
+    static conf::RealType tableTanh(conf::RealType x)
+    {
+        return tanh_table.get(x);
+    }
+
+    static conf::RealType tableSigm(conf::RealType x)
+    {
+        return 0.5 + 0.5 * tanh_table.get(0.5 * sigm_slope * x);
+    }
+
+    /// Applies the activation to an array of values, the loops are kept free of calls to be vectorized
+    static void apply(Activation activation, ActivationTier tier, conf::RealType const* in, conf::RealType* out, uint32_t count)
+    {
+        switch (activation) {
+            case Activation::None:
+                std::copy(in, in + count, out);
+                return;
+            case Activation::Relu:
+                for (uint32_t i{0}; i < count; ++i) {
+                    out[i] = (in[i] + std::abs(in[i])) * 0.5;
+                }
+                return;
+            case Activation::Sigm:
+            case Activation::Tanh:
+                break;
+        }
+
+        // Sigmoid is a scaled tanh for the approximated tiers
+        bool const           sigm  = (activation == Activation::Sigm);
+        conf::RealType const scale = sigm ? 0.5 * sigm_slope : 1.0;
+        conf::RealType const a     = sigm ? 0.5 : 0.0;
+        conf::RealType const b     = sigm ? 0.5 : 1.0;
+        switch (tier) {
+            case ActivationTier::Exact: {
+                ActivationPtr const function = getFunction(activation);
+                for (uint32_t i{0}; i < count; ++i) {
+                    out[i] = function(in[i]);
+                }
+                return;
+            }
+            case ActivationTier::Fast:
+                for (uint32_t i{0}; i < count; ++i) {
+                    out[i] = a + b * fastTanh(scale * in[i]);
+                }
+                return;
+            case ActivationTier::Table:
+                for (uint32_t i{0}; i < count; ++i) {
+                    out[i] = a + b * tanh_table.get(scale * in[i]);
+                }
+                return;
+        }
+    }
+
+private:
+    /// Samples of tanh on [-range, range]
+    struct Table
+    {
+        static constexpr uint32_t       size  = 1024;
+        static constexpr conf::RealType range = 8.0;
+        static constexpr conf::RealType step  = 2.0 * range / static_cast<conf::RealType>(size - 1);
+
+        std::array<conf::RealType, size> values{};
+
+        Table()
+        {
+            for (uint32_t i{0}; i < size; ++i) {
+                values[i] = std::tanh(-range + static_cast<conf::RealType>(i) * step);
+            }
+        }
+
+        [[nodiscard]]
+        conf::RealType get(conf::RealType x) const
+        {
+            conf::RealType const t   = (std::clamp(x, -range, range) + range) / step;
+            auto const           idx = std::min(static_cast<uint32_t>(t), size - 2);
+            conf::RealType const r   = t - static_cast<conf::RealType>(idx);
+            return values[idx] + r * (values[idx + 1] - values[idx]);
+        }
+    };
+
+    static inline Table const tanh_table{};
 };
 
 }
\ No newline at end of file
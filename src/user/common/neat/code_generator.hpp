@@ -0,0 +1,208 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "engine/common/async_writer.hpp"
+
+#include "genome.hpp"
+#include "network_generator.hpp"
+
+
+namespace nt
+{
+
+/** Emits a network as a straight-line C++ function with its constants inlined.
+ *  Nodes are computed in the order of Network::execute and their sums are accumulated in the same
+ *  order, constants are written as hexfloats, so the generated code gives the same results bit for bit
+ *  as long as both are compiled without floating point contraction (-ffp-contract=off).
+ */
+struct CodeGenerator
+{
+    /// Name of the generated namespace
+    std::string name   = "champion";
+    /// Written in the header to know where the network comes from
+    std::string source;
+
+    /** Generates the function from a network compiled with exact activations
+     *
+     * @return The content of the header, empty if the network cannot be generated
+     */
+    [[nodiscard]]
+    std::string generate(Network const& network) const
+    {
+        if (network.activation_tier != ActivationTier::Exact) {
+            std::cout << "[CodeGenerator] Only exact activations are supported" << std::endl;
+            return {};
+        }
+
+        std::stringstream code;
+        code << std::hexfloat;
+        code << "#pragma once\n"
+             << "// Generated by nt::CodeGenerator from " << source << ", do not edit\n"
+             << "#include <cmath>\n#include <limits>\n\n\n"
+             << "namespace " << name << "\n{\n\n"
+             << "constexpr unsigned input_count  = " << network.info.inputs << ";\n"
+             << "constexpr unsigned output_count = " << network.info.outputs << ";\n\n"
+             << "inline double sigm(double x)\n{\n    return 1.0 / (1.0 + std::exp(-4.9 * x));\n}\n\n"
+             << "inline double relu(double x)\n{\n    return (x + std::abs(x)) * 0.5;\n}\n\n"
+             << "inline void execute(double const* input, double* output)\n{\n"
+             << "    double sum;\n";
+
+        uint32_t const node_count = network.info.getNodeCount();
+        for (uint32_t i{0}; i < node_count; ++i) {
+            // Same evaluation order as Network::execute: input or zero, then each incoming connection, then the bias.
+            // One statement per term, nesting the terms would hit the compilers' bracket depth limit on large nodes
+            code << "    sum = " << ((i < network.info.inputs) ? "input[" + std::to_string(i) + "]" : "0.0") << ";\n";
+            for (uint32_t k{network.incoming_start[i]}; k < network.incoming_start[i + 1]; ++k) {
+                Network::Incoming const& in = network.incoming[k];
+                code << "    sum += v" << in.from << " * " << toHexfloat(in.weight) << ";\n";
+            }
+            code << "    sum += " << toHexfloat(network.node_biases[i]) << ";\n";
+            code << "    double const v" << i << " = " << getActivationName(network.node_activations[i]) << "(sum);\n";
+        }
+
+        uint32_t const first_output = network.info.inputs + network.info.hidden;
+        for (uint32_t i{0}; i < network.info.outputs; ++i) {
+            code << "    output[" << i << "] = v" << (first_output + i) << ";\n";
+        }
+        code << "}\n\n}\n";
+        return code.str();
+    }
+
+    /** Generates a program checking the generated header against reference values computed by Network::execute
+     *
+     * @param network The network used to generate the header
+     * @param header The generated header's filename, as included by the check
+     * @param sample_count Number of random input vectors
+     */
+    [[nodiscard]]
+    std::string generateCheck(Network network, std::string const& header, uint32_t sample_count = 256) const
+    {
+        std::mt19937 generator{0};
+        std::uniform_real_distribution<conf::RealType> distribution{-1.0, 1.0};
+
+        std::stringstream code;
+        code << std::hexfloat;
+        code << "// Generated by nt::CodeGenerator from " << source << ", do not edit\n"
+             << "// Compile with -ffp-contract=off to get exact results\n"
+             << "#include <cmath>\n#include <cstdio>\n\n"
+             << "#include \"" << header << "\"\n\n\n"
+             << "constexpr unsigned sample_count = " << sample_count << ";\n\n"
+             << "constexpr double inputs[sample_count][" << name << "::input_count] = {\n";
+
+        std::vector<conf::RealType> input(network.info.inputs);
+        std::vector<conf::RealType> outputs;
+        for (uint32_t s{0}; s < sample_count; ++s) {
+            for (auto& v : input) {
+                v = distribution(generator);
+            }
+            network.execute(input);
+            outputs.insert(outputs.end(), network.output.begin(), network.output.end());
+            code << "    {" << join(input.data(), network.info.inputs) << "},\n";
+        }
+        code << "};\n\n"
+             << "constexpr double outputs[sample_count][" << name << "::output_count] = {\n";
+        for (uint32_t s{0}; s < sample_count; ++s) {
+            code << "    {" << join(outputs.data() + s * network.info.outputs, network.info.outputs) << "},\n";
+        }
+        code << "};\n\n"
+             << "int main()\n{\n"
+             << "    unsigned exact     = 0;\n"
+             << "    double   max_error = 0.0;\n"
+             << "    for (unsigned s{0}; s < sample_count; ++s) {\n"
+             << "        double output[" << name << "::output_count];\n"
+             << "        " << name << "::execute(inputs[s], output);\n"
+             << "        bool same = true;\n"
+             << "        for (unsigned i{0}; i < " << name << "::output_count; ++i) {\n"
+             << "            same      = same && ((output[i] == outputs[s][i]) || (std::isnan(output[i]) && std::isnan(outputs[s][i])));\n"
+             << "            max_error = std::fmax(max_error, std::abs(output[i] - outputs[s][i]));\n"
+             << "        }\n"
+             << "        exact += same;\n"
+             << "    }\n"
+             << "    std::printf(\"Exact: %u/%u Max error: %g\\n\", exact, sample_count, max_error);\n"
+             << "    return (max_error <= 1e-9) ? 0 : 1;\n"
+             << "}\n";
+        return code.str();
+    }
+
+    /** Generates the header and its check from a genome file
+     *
+     * @param genome_filename A genome saved by Genome::writeToFile, like best_N.bin
+     * @param output_prefix The files <prefix>.hpp and <prefix>_check.cpp are created
+     */
+    static bool generateFromFile(std::string const& genome_filename, std::string const& output_prefix, std::string const& name = "champion")
+    {
+        Genome genome;
+        genome.loadFromFile(genome_filename);
+        if (genome.nodes.empty()) {
+            return false;
+        }
+        Network const network = NetworkGenerator().compile(genome, ActivationTier::Exact);
+
+        CodeGenerator generator;
+        generator.name   = name;
+        generator.source = genome_filename;
+        std::string const header = generator.generate(network);
+        if (header.empty()) {
+            return false;
+        }
+        std::string const header_filename = output_prefix + ".hpp";
+        std::string const check = generator.generateCheck(network, header_filename.substr(header_filename.find_last_of("/\\") + 1));
+
+        AsyncWriter writer;
+        writer.write(header_filename, std::vector<char>(header.begin(), header.end()));
+        writer.write(output_prefix + "_check.cpp", std::vector<char>(check.begin(), check.end()));
+        writer.flush();
+        std::cout << "[CodeGenerator] " << network.info.getNodeCount() << " nodes and " << network.incoming.size()
+                  << " connections written in " << header_filename << std::endl;
+        return true;
+    }
+
+    /// Name of the function implementing the activation in the generated code, empty for the identity
+    [[nodiscard]]
+    static std::string getActivationName(Activation activation)
+    {
+        switch (activation) {
+            case Activation::Sigm:
+                return "sigm";
+            case Activation::Relu:
+                return "relu";
+            case Activation::Tanh:
+                return "std::tanh";
+            default:
+                return "";
+        }
+    }
+
+    /// Non finite values have no literal, they are written as std::numeric_limits constants
+    [[nodiscard]]
+    static std::string toHexfloat(conf::RealType value)
+    {
+        if (std::isnan(value)) {
+            return "std::numeric_limits<double>::quiet_NaN()";
+        }
+        if (std::isinf(value)) {
+            return (value < 0.0 ? "-" : "") + std::string{"std::numeric_limits<double>::infinity()"};
+        }
+        std::stringstream ss;
+        ss << std::hexfloat << value;
+        return ss.str();
+    }
+
+    [[nodiscard]]
+    static std::string join(conf::RealType const* values, uint32_t count)
+    {
+        std::string result;
+        for (uint32_t i{0}; i < count; ++i) {
+            result += (i ? ", " : "") + toHexfloat(values[i]);
+        }
+        return result;
+    }
+};
+
+}
@@ -60,6 +60,13 @@ struct DAG
         return true;
     }
 
+    /// Adds the connection without any check, only for connections coming from an already valid graph
+    void createConnectionUnchecked(uint32_t from, uint32_t to)
+    {
+        nodes[from].out.push_back(to);
+        nodes[to].incoming++;
+    }
+
     [[nodiscard]]
     bool isValid(uint32_t i) const
     {
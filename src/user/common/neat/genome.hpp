@@ -1,9 +1,13 @@
 #pragma once
+#include <atomic>
+#include <fstream>
 #include <vector>
 
 #include "engine/common/binary_io.hpp"
+#include "engine/common/mapped_file.hpp"
 
 #include "dag.hpp"
+#include "genome_view.hpp"
 #include "network.hpp"
 #include "common_configuration.hpp"
 
@@ -40,6 +44,17 @@ public: // Attributes
     /// A graph to create valid connections
     DAG                     graph;
 
+    /** Identifies the structure of the genome, copies share it until their topology changes.
+     *  Networks compiled from a genome with the same topology id only need their values to be updated. */
+    uint64_t                topology_id    = 0;
+    /// Identifies the biases and weights, values have to be changed with setBias and setWeight
+    uint64_t                values_id      = 0;
+    /// Values the dirty sets are relative to, 0 if the changes are not tracked
+    uint64_t                base_values_id = 0;
+    /// Nodes and connections whose value changed since base_values_id
+    std::vector<uint32_t>   dirty_nodes;
+    std::vector<uint32_t>   dirty_connections;
+
 public: // Methods
     Genome() = default;
 
@@ -62,6 +77,7 @@ public: // Methods
         nodes.emplace_back();
         nodes.back().activation = activation;
         nodes.back().bias       = 0.0f;
+        onTopologyChange();
 
         graph.createNode();
         // Update info if needed
@@ -76,6 +92,7 @@ public: // Methods
     {
         if (graph.createConnection(from, to)) {
             connections.push_back({from, to, weight});
+            onTopologyChange();
             return true;
         }
         return false;
@@ -85,6 +102,7 @@ public: // Methods
     {
         graph.createConnection(from, to);
         connections.push_back({from, to, weight});
+        onTopologyChange();
     }
 
     void splitConnection(uint32_t i)
@@ -109,6 +127,53 @@ public: // Methods
         graph.removeConnection(connections[i].from, connections[i].to);
         std::swap(connections[i], connections.back());
         connections.pop_back();
+        onTopologyChange();
+    }
+
+    void setBias(uint32_t i, conf::RealType bias)
+    {
+        nodes[i].bias = bias;
+        onValueChange();
+        dirty_nodes.push_back(i);
+    }
+
+    void setWeight(uint32_t i, conf::RealType weight)
+    {
+        connections[i].weight = weight;
+        onValueChange();
+        dirty_connections.push_back(i);
+    }
+
+    /// Gives a new identity to the structure of the genome, the values are not tracked anymore
+    void onTopologyChange()
+    {
+        topology_id    = createId();
+        values_id      = createId();
+        base_values_id = 0;
+        dirty_nodes.clear();
+        dirty_connections.clear();
+    }
+
+    void onValueChange()
+    {
+        // Too many changes, it's not worth tracking them anymore
+        if (dirty_nodes.size() + dirty_connections.size() > (nodes.size() + connections.size()) / 2) {
+            base_values_id = 0;
+            dirty_nodes.clear();
+            dirty_connections.clear();
+        }
+        // Start tracking from the current values
+        if (base_values_id == 0) {
+            base_values_id = values_id;
+        }
+        values_id = createId();
+    }
+
+    [[nodiscard]]
+    static uint64_t createId()
+    {
+        static std::atomic<uint64_t> next_id{1};
+        return next_id.fetch_add(1, std::memory_order_relaxed);
     }
 
     /// Returns nodes indexes sorted topologically
@@ -159,32 +224,22 @@ public: // Methods
         return (i >= info.inputs) && (i < info.inputs + info.outputs);
     }
 
-    void writeToFile(std::string const& filename) const
-    {
-        BinaryWriter writer(filename);
-        writer.write(info);
-        for (auto const& n : nodes) {
-            writer.write(n);
-        }
-        writer.write(connections.size());
-        for (auto const& c : connections) {
-            writer.write(c);
-        }
-    }
-
-    void loadFromFile(std::string const& filename)
+    /// Reads a genome stored in the legacy raw layout, the graph is rebuilt from the connections
+    template<typename TReader>
+    bool read(TReader& reader)
     {
-        // Create the reader
-        BinaryReader reader(filename);
-        if (!reader.isValid()) {
-            std::cout << "Cannot open file \"" << filename << "\"" << std::endl;
-        }
-
         // Clear graph
         graph.nodes.clear();
+        connections.clear();
 
-        // Load info
+        // Load info, counts are checked against the remaining data before summing to avoid any overflow
         reader.readInto(info);
+        uint64_t const max_node_count = reader.getRemaining() / sizeof(Node);
+        if (!reader.isValid() || info.inputs > max_node_count || info.outputs > max_node_count || info.hidden > max_node_count
+            || uint64_t{info.inputs} + info.outputs + info.hidden > max_node_count) {
+            *this = Genome{};
+            return false;
+        }
         nodes.resize(info.getNodeCount());
 
         // Load nodes
@@ -194,11 +249,132 @@ public: // Methods
         }
 
         // Load connections
-        auto const connection_count = reader.read<size_t>();
-        for (size_t i{0}; i < connection_count; ++i) {
-            auto const c = reader.read<Connection>();
+        auto const connection_count = reader.template read<size_t>();
+        for (size_t i{0}; i < connection_count && reader.isValid(); ++i) {
+            auto const c = reader.template read<Connection>();
             createConnection(c.from, c.to, c.weight);
         }
+        onTopologyChange();
+        return reader.isValid();
+    }
+
+    /// Appends the genome to the buffer using the portable format described in GenomeFormat
+    void encode(std::vector<char>& out) const
+    {
+        uint64_t const start = out.size();
+        out.reserve(start + GenomeFormat::getEncodedSize(nodes.size(), connections.size()));
+        le::writeU32(out, GenomeFormat::magic);
+        le::writeU32(out, GenomeFormat::version);
+        le::writeU32(out, info.inputs);
+        le::writeU32(out, info.outputs);
+        le::writeU32(out, info.hidden);
+        le::writeU32(out, static_cast<uint32_t>(connections.size()));
+        // Checksum placeholder
+        le::writeU64(out, 0);
+        for (auto const& n : nodes) {
+            le::writeF64(out, static_cast<double>(n.bias));
+            le::writeU8(out, static_cast<uint8_t>(n.activation));
+            le::writeU32(out, n.depth);
+        }
+        for (auto const& c : connections) {
+            le::writeU32(out, c.from);
+            le::writeU32(out, c.to);
+            le::writeF64(out, static_cast<double>(c.weight));
+        }
+        // Now that the records are written, compute the checksum
+        uint64_t const records_start = start + GenomeFormat::header_size;
+        le::storeU64(out.data() + start + 24, computeChecksum(out.data() + records_start, out.size() - records_start));
+    }
+
+    /** Rebuilds the genome from its encoded version in O(size).
+     *  The encoded genome comes from a valid genome so the graph is not checked for cycles,
+     *  only the indexes are validated.
+     *
+     * @return false if the view is not valid or references invalid nodes, the genome is left empty in this case
+     */
+    bool decode(GenomeView const& view)
+    {
+        graph.nodes.clear();
+        nodes.clear();
+        connections.clear();
+        info = {};
+        if (!view.isValid()) {
+            return false;
+        }
+
+        uint32_t const node_count = view.getNodeCount();
+        nodes.resize(node_count);
+        graph.nodes.resize(node_count);
+        for (uint32_t i{0}; i < node_count; ++i) {
+            auto const n = view.getNode(i);
+            if (static_cast<uint8_t>(n.activation) > static_cast<uint8_t>(Activation::Tanh)) {
+                std::cout << "[WARNING] Invalid activation " << static_cast<uint32_t>(n.activation) << " for node " << i << std::endl;
+                *this = Genome{};
+                return false;
+            }
+            nodes[i] = {n.bias, n.activation, n.depth};
+        }
+
+        connections.resize(view.connection_count);
+        for (uint32_t i{0}; i < view.connection_count; ++i) {
+            auto const c = view.getConnection(i);
+            if (c.from >= node_count || c.to >= node_count || c.from == c.to) {
+                std::cout << "[WARNING] Invalid connection " << c.from << " -> " << c.to << std::endl;
+                *this = Genome{};
+                return false;
+            }
+            connections[i] = {c.from, c.to, c.weight};
+            graph.createConnectionUnchecked(c.from, c.to);
+        }
+
+        info.inputs  = view.inputs;
+        info.outputs = view.outputs;
+        info.hidden  = view.hidden;
+        onTopologyChange();
+        return true;
+    }
+
+    /// Decodes the genome at the reader's position and moves the reader after it
+    bool decode(BinaryBufferReader& reader)
+    {
+        GenomeView const view{reader.getCurrent(), reader.getRemaining()};
+        if (!decode(view)) {
+            reader.valid = false;
+            return false;
+        }
+        reader.skip(view.getEncodedSize());
+        return true;
+    }
+
+    void writeToFile(std::string const& filename) const
+    {
+        std::vector<char> data;
+        encode(data);
+        std::ofstream outfile{filename, std::ios::out | std::ios::binary};
+        outfile.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    /// Loads a genome stored in the portable format or in the legacy raw layout
+    void loadFromFile(std::string const& filename)
+    {
+        MappedFile const file{filename};
+        if (!file.isValid()) {
+            std::cout << "Cannot open file \"" << filename << "\"" << std::endl;
+            return;
+        }
+
+        if (GenomeFormat::hasMagic(file.getData(), file.getSize())) {
+            if (!decode(GenomeView{file.getData(), file.getSize()})) {
+                std::cout << "\"" << filename << "\" is corrupted" << std::endl;
+                return;
+            }
+        } else {
+            BinaryBufferReader reader{file.getData(), file.getSize()};
+            if (!read(reader)) {
+                std::cout << "\"" << filename << "\" is corrupted" << std::endl;
+                return;
+            }
+        }
 
         std::cout << "\"" << filename << "\" loaded." << std::endl;
     }
@@ -0,0 +1,156 @@
+#pragma once
+#include <cstdint>
+
+#include "engine/common/binary_io.hpp"
+
+#include "activation.hpp"
+#include "common_configuration.hpp"
+
+
+namespace nt
+{
+/** Portable genome format, all values are little-endian and records are packed
+ *
+ *  Header      | magic u32 | version u32 | inputs u32 | outputs u32 | hidden u32 | connections u32 | checksum u64 |
+ *  Node        | bias f64 | activation u8 | depth u32 |
+ *  Connection  | from u32 | to u32 | weight f64 |
+ *
+ *  The checksum covers the nodes and connections records.
+ */
+struct GenomeFormat
+{
+    static constexpr uint32_t magic   = 0x4E47544E; // "NTGN"
+    static constexpr uint32_t version = 1;
+
+    static constexpr uint64_t header_size     = 32;
+    static constexpr uint64_t node_size       = 13;
+    static constexpr uint64_t connection_size = 16;
+
+    [[nodiscard]]
+    static uint64_t getEncodedSize(uint64_t node_count, uint64_t connection_count)
+    {
+        return header_size + node_count * node_size + connection_count * connection_size;
+    }
+
+    /// Checks if the data starts with the format's magic number
+    [[nodiscard]]
+    static bool hasMagic(const char* data, uint64_t size)
+    {
+        return size >= 4 && le::readU32(data) == magic;
+    }
+};
+
+/** Read only access to an encoded genome, nothing is copied.
+ *  Only the header is decoded at construction, records are decoded on access.
+ */
+struct GenomeView
+{
+    struct Node
+    {
+        conf::RealType bias       = 0.0;
+        Activation     activation = Activation::None;
+        uint32_t       depth      = 0;
+    };
+
+    struct Connection
+    {
+        uint32_t       from   = 0;
+        uint32_t       to     = 0;
+        conf::RealType weight = 0.0;
+    };
+
+    const char* data             = nullptr;
+    uint64_t    size             = 0;
+    uint32_t    inputs           = 0;
+    uint32_t    outputs          = 0;
+    uint32_t    hidden           = 0;
+    uint32_t    connection_count = 0;
+    bool        valid            = false;
+
+    /** Decodes the header and ensures that all records are within the data
+     *
+     * @param data_ The encoded genome, it can be followed by other data
+     * @param size_ The available size
+     * @param verify_checksum If false, the records are not read until accessed
+     */
+    GenomeView(const char* data_, uint64_t size_, bool verify_checksum = true)
+        : data{data_}
+        , size{size_}
+    {
+        if (size < GenomeFormat::header_size || !GenomeFormat::hasMagic(data, size)) {
+            return;
+        }
+        if (le::readU32(data + 4) != GenomeFormat::version) {
+            return;
+        }
+        inputs           = le::readU32(data + 8);
+        outputs          = le::readU32(data + 12);
+        hidden           = le::readU32(data + 16);
+        connection_count = le::readU32(data + 20);
+        // Counts come from the data, check each of them before summing to avoid any overflow
+        uint64_t const max_node_count = (size - GenomeFormat::header_size) / GenomeFormat::node_size;
+        if (inputs > max_node_count || outputs > max_node_count || hidden > max_node_count) {
+            return;
+        }
+        uint64_t const node_count = uint64_t{inputs} + outputs + hidden;
+        if (node_count > max_node_count) {
+            return;
+        }
+        uint64_t const encoded_size = getEncodedSize();
+        if (encoded_size > size) {
+            return;
+        }
+        if (verify_checksum) {
+            uint64_t const checksum = le::readU64(data + 24);
+            if (checksum != computeChecksum(data + GenomeFormat::header_size, encoded_size - GenomeFormat::header_size)) {
+                return;
+            }
+        }
+        valid = true;
+    }
+
+    [[nodiscard]]
+    bool isValid() const
+    {
+        return valid;
+    }
+
+    /// Only meaningful if the view is valid, the counts are checked against the data size at construction
+    [[nodiscard]]
+    uint32_t getNodeCount() const
+    {
+        return inputs + hidden + outputs;
+    }
+
+    /// Size of the encoded genome, the data can be larger
+    [[nodiscard]]
+    uint64_t getEncodedSize() const
+    {
+        return GenomeFormat::getEncodedSize(getNodeCount(), connection_count);
+    }
+
+    [[nodiscard]]
+    Node getNode(uint32_t i) const
+    {
+        const char* const record = data + GenomeFormat::header_size + i * GenomeFormat::node_size;
+        return {
+            static_cast<conf::RealType>(le::readF64(record)),
+            static_cast<Activation>(le::readU8(record + 8)),
+            le::readU32(record + 9)
+        };
+    }
+
+    [[nodiscard]]
+    Connection getConnection(uint32_t i) const
+    {
+        const char* const record = data + GenomeFormat::header_size
+                                 + getNodeCount() * GenomeFormat::node_size
+                                 + i * GenomeFormat::connection_size;
+        return {
+            le::readU32(record),
+            le::readU32(record + 4),
+            static_cast<conf::RealType>(le::readF64(record + 8))
+        };
+    }
+};
+}
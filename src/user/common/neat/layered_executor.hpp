@@ -0,0 +1,276 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+
+#include "network.hpp"
+
+
+namespace nt
+{
+
+enum class ExecutionMode : uint8_t
+{
+    /// Network::execute, each node gathers the values of its sources
+    Gather,
+    /// LayeredExecutor, nodes of the same depth are evaluated together
+    Layered,
+    /// Layered if the network has a wide enough layer, else Gather
+    Auto,
+    /// QuantizedNetwork<int16_t>
+    Int16,
+    /// QuantizedNetwork<int8_t>
+    Int8,
+    /// NetworkJit, Gather where it is not supported
+    Jit,
+};
+
+/** Evaluates a network layer by layer, a layer being a run of consecutive nodes sharing the same depth.
+ *  The incoming connections of a layer are packed in a matrix multiplied by the values of the
+ *  layer's source nodes. The matrix is stored dense if all its entries are used, else in CSR, so a
+ *  non finite value never meets the zero of a missing connection.
+ *  Activations are applied with ActivationFunction::apply on runs of consecutive nodes sharing the same activation.
+ *  CSR layers sum in the same order as Network::execute, dense layers sum in sorted source order so their
+ *  results are only equal to within rounding. Connections values are not updated.
+ */
+struct LayeredExecutor
+{
+    struct Layer
+    {
+        uint32_t first_node    = 0;
+        uint32_t node_count    = 0;
+        /// Range in sources
+        uint32_t sources_start = 0;
+        uint32_t sources_count = 0;
+        bool     dense         = false;
+        /// Dense: start of the row major matrix in weights. Sparse: start of the rows in row_offsets
+        uint32_t data_start    = 0;
+        /// Range in runs
+        uint32_t runs_start    = 0;
+        uint32_t runs_count    = 0;
+    };
+
+    /// Consecutive nodes of a layer with the same activation
+    struct Run
+    {
+        /// Index of the first node, relative to the layer's first node
+        uint32_t   offset     = 0;
+        uint32_t   count      = 0;
+        Activation activation = Activation::None;
+    };
+
+    std::vector<Layer>          layers;
+    std::vector<Run>            runs;
+    /// Nodes read by each layer, sorted
+    std::vector<uint32_t>       sources;
+    /// Dense layers matrices
+    std::vector<conf::RealType> weights;
+    /// Sparse layers, CSR matrices
+    std::vector<conf::RealType> sparse_weights;
+    std::vector<uint32_t>       columns;
+    std::vector<uint32_t>       row_offsets;
+
+    /// Activated value of each node
+    std::vector<conf::RealType> values;
+    /// Values of the current layer's sources
+    std::vector<conf::RealType> gathered;
+    /// Sums of the current layer's nodes
+    std::vector<conf::RealType> sums;
+
+    /// Ids of the network the executor has been built from
+    uint64_t       topology_id     = 0;
+    uint64_t       values_id       = 0;
+    ActivationTier activation_tier = ActivationTier::Exact;
+
+    /// Number of nodes of the widest layer of the network
+    [[nodiscard]]
+    static uint32_t getMaxLayerSize(Network const& network)
+    {
+        uint32_t const node_count = network.info.getNodeCount();
+        uint32_t max_size = 0;
+        for (uint32_t first{0}; first < node_count;) {
+            uint32_t end = first + 1;
+            while (end < node_count && network.node_depths[end] == network.node_depths[first]) {
+                ++end;
+            }
+            max_size = std::max(max_size, end - first);
+            first = end;
+        }
+        return max_size;
+    }
+
+    void build(Network const& network)
+    {
+        layers.clear();
+        runs.clear();
+        sources.clear();
+        weights.clear();
+        sparse_weights.clear();
+        columns.clear();
+        row_offsets.clear();
+
+        topology_id     = network.topology_id;
+        values_id       = network.values_id;
+        activation_tier = network.activation_tier;
+
+        uint32_t const node_count = network.info.getNodeCount();
+        values.assign(node_count, 0.0);
+
+        // Incoming connections of each node, in the order Network::execute sums them (kept by the CSR layers)
+        auto const getIncoming = [&network](uint32_t i) {
+            auto const begin = network.incoming.begin();
+            return std::make_pair(begin + network.incoming_start[i], begin + network.incoming_start[i + 1]);
+        };
+
+        uint32_t max_layer_size = 0;
+        uint32_t max_sources    = 0;
+        for (uint32_t first{0}; first < node_count;) {
+            // Nodes are sorted by depth, a layer is a run of nodes with the same depth
+            uint32_t end = first + 1;
+            while (end < node_count && network.node_depths[end] == network.node_depths[first]) {
+                ++end;
+            }
+
+            Layer layer;
+            layer.first_node    = first;
+            layer.node_count    = end - first;
+            layer.sources_start = static_cast<uint32_t>(sources.size());
+
+            uint32_t edges_count = 0;
+            for (uint32_t i{first}; i < end; ++i) {
+                auto const [begin, last] = getIncoming(i);
+                for (auto it{begin}; it != last; ++it) {
+                    sources.push_back(it->from);
+                }
+                edges_count += static_cast<uint32_t>(last - begin);
+            }
+            std::sort(sources.begin() + layer.sources_start, sources.end());
+            sources.erase(std::unique(sources.begin() + layer.sources_start, sources.end()), sources.end());
+            layer.sources_count = static_cast<uint32_t>(sources.size()) - layer.sources_start;
+
+            auto const getColumn = [&](uint32_t from) {
+                auto const begin = sources.begin() + layer.sources_start;
+                return static_cast<uint32_t>(std::lower_bound(begin, sources.end(), from) - begin);
+            };
+
+            uint64_t const matrix_size = static_cast<uint64_t>(layer.node_count) * layer.sources_count;
+            // Each node is connected to each source: the matrix has no padding zero
+            layer.dense = matrix_size && (edges_count == matrix_size);
+            if (layer.dense) {
+                layer.data_start = static_cast<uint32_t>(weights.size());
+                weights.resize(weights.size() + matrix_size, 0.0);
+                for (uint32_t r{0}; r < layer.node_count; ++r) {
+                    auto const [begin, last] = getIncoming(first + r);
+                    for (auto it{begin}; it != last; ++it) {
+                        weights[layer.data_start + r * layer.sources_count + getColumn(it->from)] = it->weight;
+                    }
+                }
+            } else {
+                layer.data_start = static_cast<uint32_t>(row_offsets.size());
+                for (uint32_t r{0}; r < layer.node_count; ++r) {
+                    row_offsets.push_back(static_cast<uint32_t>(sparse_weights.size()));
+                    auto const [begin, last] = getIncoming(first + r);
+                    for (auto it{begin}; it != last; ++it) {
+                        sparse_weights.push_back(it->weight);
+                        columns.push_back(getColumn(it->from));
+                    }
+                }
+                row_offsets.push_back(static_cast<uint32_t>(sparse_weights.size()));
+            }
+
+            layer.runs_start = static_cast<uint32_t>(runs.size());
+            for (uint32_t i{first}; i < end; ++i) {
+                if (i == first || network.node_activations[i] != runs.back().activation) {
+                    runs.push_back({i - first, 0, network.node_activations[i]});
+                }
+                ++runs.back().count;
+            }
+            layer.runs_count = static_cast<uint32_t>(runs.size()) - layer.runs_start;
+
+            max_layer_size = std::max(max_layer_size, layer.node_count);
+            max_sources    = std::max(max_sources, layer.sources_count);
+            layers.push_back(layer);
+            first = end;
+        }
+
+        gathered.resize(max_sources);
+        sums.resize(max_layer_size);
+    }
+
+    /// Checks if the executor has been built from this version of the network
+    [[nodiscard]]
+    bool isUpToDate(Network const& network) const
+    {
+        return !layers.empty() &&
+               topology_id     == network.topology_id &&
+               values_id       == network.values_id &&
+               activation_tier == network.activation_tier;
+    }
+
+    bool execute(Network& network, std::vector<conf::RealType> const& input)
+    {
+        if (input.size() != network.info.inputs) {
+            std::cout << "Input size mismatch, aborting" << std::endl;
+            return false;
+        }
+
+        for (Layer const& layer : layers) {
+            // Gather the values used by the layer
+            for (uint32_t i{0}; i < layer.sources_count; ++i) {
+                gathered[i] = values[sources[layer.sources_start + i]];
+            }
+            // Inputs sums are initialized with the input, other nodes start from zero
+            for (uint32_t r{0}; r < layer.node_count; ++r) {
+                uint32_t const node_idx = layer.first_node + r;
+                sums[r] = (node_idx < network.info.inputs) ? input[node_idx] : 0.0;
+            }
+
+            if (layer.dense) {
+                gemv(weights.data() + layer.data_start, gathered.data(), sums.data(), layer.node_count, layer.sources_count);
+            } else if (layer.sources_count) {
+                spmv(layer);
+            }
+
+            for (uint32_t r{0}; r < layer.node_count; ++r) {
+                sums[r] += network.node_biases[layer.first_node + r];
+            }
+            // One call per run instead of one indirect call per node
+            for (uint32_t k{layer.runs_start}; k < layer.runs_start + layer.runs_count; ++k) {
+                Run const& run = runs[k];
+                ActivationFunction::apply(run.activation, activation_tier, sums.data() + run.offset, values.data() + layer.first_node + run.offset, run.count);
+            }
+        }
+
+        uint32_t const first_output = network.info.inputs + network.info.hidden;
+        for (uint32_t i{0}; i < network.info.outputs; ++i) {
+            network.output[i] = values[first_output + i];
+        }
+        return true;
+    }
+
+    /// y += W.x with W a row major matrix
+    static void gemv(conf::RealType const* w, conf::RealType const* x, conf::RealType* y, uint32_t rows, uint32_t cols)
+    {
+        for (uint32_t r{0}; r < rows; ++r) {
+            conf::RealType const* row = w + r * cols;
+            conf::RealType sum = y[r];
+            for (uint32_t c{0}; c < cols; ++c) {
+                sum += row[c] * x[c];
+            }
+            y[r] = sum;
+        }
+    }
+
+    void spmv(Layer const& layer)
+    {
+        uint32_t const* offsets = row_offsets.data() + layer.data_start;
+        for (uint32_t r{0}; r < layer.node_count; ++r) {
+            conf::RealType sum = sums[r];
+            for (uint32_t k{offsets[r]}; k < offsets[r + 1]; ++k) {
+                sum += sparse_weights[k] * gathered[columns[k]];
+            }
+            sums[r] = sum;
+        }
+    }
+};
+
+}
@@ -31,16 +31,18 @@ struct Mutator
 
     static void mutateBiases(nt::Genome& genome)
     {
-        Genome::Node& n = pickRandom(genome.nodes);
+        uint32_t const idx  = getRandIndex(genome.nodes.size());
+        conf::RealType bias = genome.nodes[idx].bias;
         if (RNGf::proba(::conf::mut::new_value_proba)) {
-            n.bias = RNGf::getFullRange(::conf::mut::weight_range);
+            bias = RNGf::getFullRange(::conf::mut::weight_range);
         } else {
             if (RNGf::proba(0.25f)) {
-                n.bias += RNGf::getFullRange(::conf::mut::weight_range);
+                bias += RNGf::getFullRange(::conf::mut::weight_range);
             } else {
-                n.bias += ::conf::mut::weight_small_range * RNGf::getFullRange(::conf::mut::weight_range);
+                bias += ::conf::mut::weight_small_range * RNGf::getFullRange(::conf::mut::weight_range);
             }
         }
+        genome.setBias(idx, bias);
     }
 
     static void mutateWeights(nt::Genome& genome)
@@ -50,17 +52,19 @@ struct Mutator
             return;
         }
 
-        Genome::Connection& c = pickRandom(genome.connections);
+        uint32_t const idx    = getRandIndex(genome.connections.size());
+        conf::RealType weight = genome.connections[idx].weight;
         if (RNGf::proba(::conf::mut::new_value_proba)) {
-            c.weight = RNGf::getFullRange(::conf::mut::weight_range);
+            weight = RNGf::getFullRange(::conf::mut::weight_range);
         } else {
             if (RNGf::proba(0.75f)) {
-                c.weight += ::conf::mut::weight_small_range * RNGf::getFullRange(::conf::mut::weight_range);
+                weight += ::conf::mut::weight_small_range * RNGf::getFullRange(::conf::mut::weight_range);
             } else {
-                c.weight += RNGf::getFullRange(::conf::mut::weight_range);
+                weight += RNGf::getFullRange(::conf::mut::weight_range);
             }
 
         }
+        genome.setWeight(idx, weight);
     }
 
     static void newNode(nt::Genome& genome)
@@ -102,12 +106,5 @@ struct Mutator
         auto const max_value_f = static_cast<float>(max_value);
         return static_cast<uint32_t>(RNGf::getUnder(max_value_f));
     }
-
-    template<typename TDataType>
-    static TDataType& pickRandom(std::vector<TDataType>& container)
-    {
-        uint32_t const idx = getRandIndex(container.size());
-        return container[idx];
-    }
 };
 }
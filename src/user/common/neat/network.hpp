@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <vector>
 
 #include "activation.hpp"
@@ -32,44 +33,62 @@ public: // Internal structs
         }
     };
 
-    struct Node
-    {
-        ActivationPtr activation       = ActivationFunction::none;
-        conf::RealType      sum              = 0.0;
-        conf::RealType      bias             = 0.0;
-        uint32_t      connection_count = 0;
-        uint32_t      depth            = 0;
-
-        [[nodiscard]]
-        conf::RealType getValue() const
-        {
-            return activation(sum + bias);
-        }
-    };
-
+#pragma pack(push, 4)
+    /// Outgoing connection, packed in 12 bytes
     struct Connection
     {
-        uint32_t to      = 0;
+        uint32_t       to     = 0;
         conf::RealType weight = 0.0;
-        conf::RealType value  = 0.0;
     };
 
-    union Slot
+    /// Connection as seen by its target node, packed in 12 bytes
+    struct Incoming
     {
-        // By default, slot is initialized as a Node, just to allow resizing
-        Node       node       = {};
-        Connection connection;
-
-        // Constructor required to use resize on vector
-        Slot()
-            : node{}
-        {}
+        uint32_t       from   = 0;
+        conf::RealType weight = 0.0;
     };
+#pragma pack(pop)
 
 public: // Attributes
-    std::vector<Slot>     slots;
+    /// Nodes, sorted in execution order
+    std::vector<conf::RealType> node_biases;
+    std::vector<Activation>     node_activations;
+    /// Number of outgoing connections of each node
+    std::vector<uint32_t>       node_connection_counts;
+    std::vector<uint32_t>       node_depths;
+    /// Sum of each node before its bias and activation, only updated if record_values is set
+    std::vector<conf::RealType> node_sums;
+
+    /// Outgoing connections, sorted by source node
+    std::vector<Connection>     connections;
+    /// Value carried by each connection, only updated if record_values is set
+    std::vector<conf::RealType> connection_values;
+
     std::vector<conf::RealType> output;
 
+    /// Incoming connections of each node, contiguous and sorted by source node
+    std::vector<Incoming>       incoming;
+    std::vector<uint32_t>       incoming_start;
+    /// Position in incoming of each connection
+    std::vector<uint32_t>       connection_incoming;
+    /// Output value of each node
+    std::vector<conf::RealType> values;
+    /// If set, execute also stores the nodes sums and the connections values, only needed to render them
+    bool                        record_values = false;
+
+    /// Functions of the activation tier, indexed by activation id
+    std::array<ActivationPtr, 4> activation_functions = getActivationFunctions(ActivationTier::Exact);
+
+    /// Genome's ids at compilation, see NetworkGenerator::update
+    uint64_t       topology_id     = 0;
+    uint64_t       values_id       = 0;
+    ActivationTier activation_tier = ActivationTier::Exact;
+    /// Index in the network of each genome node and connection, or one of the values below if pruned
+    std::vector<uint32_t> node_slots;
+    std::vector<uint32_t> connection_slots;
+    static constexpr uint32_t pruned_slot      = 0xFFFFFFFF;
+    static constexpr uint32_t zero_weight_slot = 0xFFFFFFFE;
+
     Info     info;
     uint32_t max_depth        = 0;
     uint32_t connection_count = 0;
@@ -77,60 +96,93 @@ public: // Attributes
 public: // Methods
     Network() = default;
 
-    /// Initializes the slots vector
-    void initialize(Info const& info_, uint32_t connection_count_)
+    /// Allocates nodes and connections
+    void initialize(Info const& info_, uint32_t connection_count_, ActivationTier tier = ActivationTier::Exact)
     {
         info             = info_;
         connection_count = connection_count_;
+        activation_tier  = tier;
+        activation_functions = getActivationFunctions(tier);
 
-        slots.resize(info.getNodeCount() + connection_count);
+        uint32_t const node_count = info.getNodeCount();
+        node_biases.resize(node_count);
+        node_activations.resize(node_count);
+        node_connection_counts.resize(node_count);
+        node_depths.resize(node_count);
+        node_sums.resize(node_count);
+        connections.resize(connection_count);
+        connection_values.resize(connection_count);
         output.resize(info.outputs);
     }
 
     void setNode(uint32_t i, Activation activation, conf::RealType bias, uint32_t connection_count_)
     {
-        getNode(i).activation       = ActivationFunction::getFunction(activation);
-        getNode(i).bias             = bias;
-        getNode(i).connection_count = connection_count_;
+        node_activations[i]       = activation;
+        node_biases[i]            = bias;
+        node_connection_counts[i] = connection_count_;
     }
 
     void setNodeDepth(uint32_t i, uint32_t depth)
     {
-        slots[i].node.depth = depth;
+        node_depths[i] = depth;
     }
 
     void setConnection(uint32_t i, uint32_t to, conf::RealType weight)
     {
-        Connection& connection = getConnection(i);
-        connection.to     = to;
-        connection.weight = weight;
+        connections[i] = {to, weight};
     }
 
-    [[nodiscard]]
-    Connection const& getConnection(uint32_t i) const
+    /// Changes the weight of a connection once the incoming lists are built
+    void setConnectionWeight(uint32_t i, conf::RealType weight)
     {
-        return slots[info.getNodeCount() + i].connection;
+        connections[i].weight = weight;
+        incoming[connection_incoming[i]].weight = weight;
     }
 
-    Connection& getConnection(uint32_t i)
+    /// Builds the incoming connections lists from the connections, has to be called once all connections are set
+    void buildIncoming()
     {
-        return slots[info.getNodeCount() + i].connection;
-    }
+        uint32_t const node_count = info.getNodeCount();
+        incoming_start.assign(node_count + 1, 0);
+        for (Connection const& c : connections) {
+            ++incoming_start[c.to + 1];
+        }
+        for (uint32_t i{0}; i < node_count; ++i) {
+            incoming_start[i + 1] += incoming_start[i];
+        }
 
-    Node& getNode(uint32_t i)
-    {
-        return slots[i].node;
+        // Connections are sorted by source node, so are the incoming lists
+        incoming.resize(connection_count);
+        connection_incoming.resize(connection_count);
+        std::vector<uint32_t> cursor(incoming_start.begin(), incoming_start.end() - 1);
+        uint32_t connection_idx = 0;
+        for (uint32_t i{0}; i < node_count; ++i) {
+            for (uint32_t o{0}; o < node_connection_counts[i]; ++o) {
+                Connection const& c = connections[connection_idx];
+                uint32_t const    position = cursor[c.to]++;
+                incoming[position]                  = {i, c.weight};
+                connection_incoming[connection_idx] = position;
+                ++connection_idx;
+            }
+        }
+        values.resize(node_count);
     }
 
     [[nodiscard]]
-    Node const& getNode(uint32_t i) const
+    ActivationPtr getActivation(uint32_t i) const
     {
-        return slots[i].node;
+        return activation_functions[static_cast<uint32_t>(node_activations[i])];
     }
 
-    Node& getOutput(uint32_t i)
-    {
-        return slots[info.inputs + info.hidden + i].node;
+    [[nodiscard]]
+    static std::array<ActivationPtr, 4> getActivationFunctions(ActivationTier tier)
+    {
+        return {
+            ActivationFunction::getFunction(Activation::None, tier),
+            ActivationFunction::getFunction(Activation::Sigm, tier),
+            ActivationFunction::getFunction(Activation::Relu, tier),
+            ActivationFunction::getFunction(Activation::Tanh, tier),
+        };
     }
 
     bool execute(std::vector<conf::RealType> const& input)
@@ -141,32 +193,30 @@ public: // Methods
             return false;
         }
 
-        // Reset nodes
-        foreachNode([](Node& n, uint32_t) {
-            n.sum = 0.0;
-        });
-
-        // Initialize input
-        for (uint32_t i{0}; i < info.inputs; ++i) {
-            slots[i].node.sum = input[i];
-        }
-
-        // Execute network
-        uint32_t current_connection = 0;
+        // Execute network, each node gathers the values of its already computed sources
         uint32_t const node_count = info.getNodeCount();
         for (uint32_t i{0}; i < node_count; ++i) {
-            Node const&    node  = slots[i].node;
-            conf::RealType const value = node.getValue();
-            for (uint32_t o{0}; o < node.connection_count; ++o) {
-                Connection& c = getConnection(current_connection++);
-                c.value = value * c.weight;
-                getNode(c.to).sum += c.value;
+            conf::RealType sum = (i < info.inputs) ? input[i] : 0.0;
+            for (uint32_t k{incoming_start[i]}; k < incoming_start[i + 1]; ++k) {
+                Incoming const& in = incoming[k];
+                sum += values[in.from] * in.weight;
+            }
+            values[i] = getActivation(i)(sum + node_biases[i]);
+            if (record_values) {
+                node_sums[i] = sum;
+            }
+        }
+
+        if (record_values) {
+            for (uint32_t i{0}; i < connection_count; ++i) {
+                connection_values[i] = values[incoming[connection_incoming[i]].from] * connections[i].weight;
             }
         }
 
         // Update output
+        uint32_t const first_output = info.inputs + info.hidden;
         for (uint32_t i{0}; i < info.outputs; ++i) {
-            output[i] = getOutput(i).getValue();
+            output[i] = values[first_output + i];
         }
 
         return true;
@@ -178,32 +228,6 @@ public: // Methods
         return output;
     }
 
-    template<typename TCallback>
-    void foreachNode(TCallback&& callback)
-    {
-        uint32_t const node_count = info.getNodeCount();
-        for (uint32_t i{0}; i < node_count; ++i) {
-            callback(slots[i].node, i);
-        }
-    }
-
-    template<typename TCallback>
-    void foreachNode(TCallback&& callback) const
-    {
-        uint32_t const node_count = info.getNodeCount();
-        for (uint32_t i{0}; i < node_count; ++i) {
-            callback(slots[i].node, i);
-        }
-    }
-
-    template<typename TCallback>
-    void foreachConnection(TCallback&& callback) const
-    {
-        for (uint32_t i{0}; i < connection_count; ++i) {
-            callback(getConnection(i), i);
-        }
-    }
-
     /// Returns the depth of the network
     [[nodiscard]]
     uint32_t getDepth() const
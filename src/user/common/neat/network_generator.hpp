@@ -8,15 +8,31 @@ namespace nt
 {
 struct NetworkGenerator
 {
+    enum class UpdateResult : uint8_t
+    {
+        Unchanged,
+        Patched,
+        Rebuilt,
+    };
+
     std::vector<uint32_t> idx_to_order;
+    /// Index in the network of each connection of the last generated genome
+    std::vector<uint32_t> connection_order;
+    /// Index in the pruned genome of each node and connection of the last pruned genome
+    std::vector<uint32_t> pruned_node_idx;
+    std::vector<uint32_t> pruned_connection_idx;
 
     NetworkGenerator() = default;
 
-    Network generate(nt::Genome& genome)
+    /// Generates a network executing the whole genome
+    Network generate(nt::Genome& genome, ActivationTier tier = ActivationTier::Exact)
     {
         idx_to_order.resize(genome.info.getNodeCount());
+        connection_order.resize(genome.connections.size());
         Network network;
-        network.initialize(genome.info, static_cast<uint32_t>(genome.connections.size()));
+        network.initialize(genome.info, static_cast<uint32_t>(genome.connections.size()), tier);
+        network.topology_id = genome.topology_id;
+        network.values_id   = genome.values_id;
 
         auto const order = getOrder(genome);
         for (uint32_t i{0}; i < order.size(); ++i) {
@@ -32,12 +48,15 @@ struct NetworkGenerator
             network.setNode(node_idx, node.activation, node.bias, genome.graph.nodes[o].getOutConnectionCount());
             network.setNodeDepth(node_idx, node.depth);
             // Create its connections
-            for (auto const& c : genome.connections) {
+            uint32_t const genome_connection_count = static_cast<uint32_t>(genome.connections.size());
+            for (uint32_t i{0}; i < genome_connection_count; ++i) {
+                auto const& c = genome.connections[i];
                 if (c.from == o) {
                     uint32_t const target = idx_to_order[c.to];
                     // Target node should be processed after this one
                     assert(target > node_idx);
                     network.setConnection(connection_idx, target, c.weight);
+                    connection_order[i] = connection_idx;
                     ++connection_idx;
                 }
             }
@@ -45,11 +64,197 @@ struct NetworkGenerator
         }
 
         // Update network's max depth
-        network.max_depth = network.getNode(node_idx - 1).depth;
+        network.max_depth = network.node_depths[node_idx - 1];
+        network.buildIncoming();
 
         return network;
     }
 
+    /// Generates a network without the nodes and connections that cannot influence the outputs
+    Network compile(nt::Genome const& genome, ActivationTier tier = ActivationTier::Exact)
+    {
+        nt::Genome pruned = prune(genome);
+        Network network = generate(pruned, tier);
+
+        // Keep track of where each genome element ended up to allow updates
+        network.topology_id     = genome.topology_id;
+        network.values_id       = genome.values_id;
+        network.activation_tier = tier;
+        network.node_slots.resize(genome.nodes.size());
+        for (uint32_t i{0}; i < genome.nodes.size(); ++i) {
+            uint32_t const idx = pruned_node_idx[i];
+            network.node_slots[i] = (idx == Network::pruned_slot) ? idx : idx_to_order[idx];
+        }
+        network.connection_slots.resize(genome.connections.size());
+        for (uint32_t i{0}; i < genome.connections.size(); ++i) {
+            uint32_t const idx = pruned_connection_idx[i];
+            network.connection_slots[i] = (idx >= Network::zero_weight_slot) ? idx : connection_order[idx];
+        }
+        return network;
+    }
+
+    /** Updates a network compiled from a previous version of the genome.
+     *  If the genome kept the same topology, only the modified biases and weights are written in the network,
+     *  else the network is compiled again.
+     */
+    UpdateResult update(Network& network, nt::Genome const& genome, ActivationTier tier = ActivationTier::Exact)
+    {
+        if (network.topology_id == 0 || network.topology_id != genome.topology_id || network.activation_tier != tier) {
+            network = compile(genome, tier);
+            return UpdateResult::Rebuilt;
+        }
+        if (network.values_id == genome.values_id) {
+            return UpdateResult::Unchanged;
+        }
+
+        bool patched;
+        if (genome.base_values_id == network.values_id) {
+            // Only apply the changes since the network's values
+            patched = patchValues(network, genome, genome.dirty_nodes, genome.dirty_connections);
+        } else {
+            patched = patchAllValues(network, genome);
+        }
+
+        if (!patched) {
+            network = compile(genome, tier);
+            return UpdateResult::Rebuilt;
+        }
+        network.values_id = genome.values_id;
+        return UpdateResult::Patched;
+    }
+
+    /// Returns false if a connection removed for its zero weight is now needed
+    static bool patchValues(Network& network, nt::Genome const& genome, std::vector<uint32_t> const& nodes, std::vector<uint32_t> const& connections)
+    {
+        for (uint32_t const i : connections) {
+            if (!patchConnection(network, genome, i)) {
+                return false;
+            }
+        }
+        for (uint32_t const i : nodes) {
+            patchNode(network, genome, i);
+        }
+        return true;
+    }
+
+    static bool patchAllValues(Network& network, nt::Genome const& genome)
+    {
+        for (uint32_t i{0}; i < genome.connections.size(); ++i) {
+            if (!patchConnection(network, genome, i)) {
+                return false;
+            }
+        }
+        for (uint32_t i{0}; i < genome.nodes.size(); ++i) {
+            patchNode(network, genome, i);
+        }
+        return true;
+    }
+
+    static bool patchConnection(Network& network, nt::Genome const& genome, uint32_t i)
+    {
+        uint32_t const slot   = network.connection_slots[i];
+        auto const     weight = genome.connections[i].weight;
+        if (slot == Network::zero_weight_slot) {
+            // The connection may revive pruned nodes
+            return weight == 0.0;
+        }
+        if (slot != Network::pruned_slot) {
+            // A connection becoming zero could be pruned, keeping it gives the same result
+            network.setConnectionWeight(slot, weight);
+        }
+        return true;
+    }
+
+    static void patchNode(Network& network, nt::Genome const& genome, uint32_t i)
+    {
+        uint32_t const slot = network.node_slots[i];
+        if (slot != Network::pruned_slot) {
+            network.node_biases[slot] = genome.nodes[i].bias;
+        }
+    }
+
+    /** Removes zero-weight connections, then the hidden nodes that do not reach any output
+     *  and the connections leading to them. Inputs and outputs are always kept with the same indexes.
+     */
+    [[nodiscard]]
+    nt::Genome prune(nt::Genome const& genome)
+    {
+        auto const node_count = static_cast<uint32_t>(genome.nodes.size());
+
+        // Incoming live connections of each node
+        std::vector<uint32_t> incoming_start(node_count + 1, 0);
+        for (auto const& c : genome.connections) {
+            if (c.weight != 0.0) {
+                ++incoming_start[c.to + 1];
+            }
+        }
+        for (uint32_t i{0}; i < node_count; ++i) {
+            incoming_start[i + 1] += incoming_start[i];
+        }
+        std::vector<uint32_t> incoming(incoming_start[node_count]);
+        {
+            std::vector<uint32_t> cursor(incoming_start.begin(), incoming_start.end() - 1);
+            for (auto const& c : genome.connections) {
+                if (c.weight != 0.0) {
+                    incoming[cursor[c.to]++] = c.from;
+                }
+            }
+        }
+
+        // Walk the graph backward from the outputs
+        std::vector<uint8_t>  reaches_output(node_count, 0);
+        std::vector<uint32_t> to_visit;
+        to_visit.reserve(node_count);
+        for (uint32_t i{0}; i < genome.info.outputs; ++i) {
+            uint32_t const output_idx = genome.info.inputs + i;
+            reaches_output[output_idx] = 1;
+            to_visit.push_back(output_idx);
+        }
+        while (!to_visit.empty()) {
+            uint32_t const idx = to_visit.back();
+            to_visit.pop_back();
+            for (uint32_t i{incoming_start[idx]}; i < incoming_start[idx + 1]; ++i) {
+                uint32_t const from = incoming[i];
+                if (!reaches_output[from]) {
+                    reaches_output[from] = 1;
+                    to_visit.push_back(from);
+                }
+            }
+        }
+
+        // Create the remaining nodes, inputs and outputs are the first ones in genomes
+        nt::Genome pruned;
+        pruned.info = {genome.info.inputs, genome.info.outputs};
+        pruned_node_idx.assign(node_count, Network::pruned_slot);
+        for (uint32_t i{0}; i < node_count; ++i) {
+            bool const io = genome.isInput(i) || genome.isOutput(i);
+            if (io || reaches_output[i]) {
+                pruned_node_idx[i] = static_cast<uint32_t>(pruned.nodes.size());
+                pruned.nodes.push_back(genome.nodes[i]);
+                pruned.graph.createNode();
+                pruned.info.hidden += io ? 0 : 1;
+            }
+        }
+
+        // A connection to a node reaching an output also comes from one
+        auto const connection_count = static_cast<uint32_t>(genome.connections.size());
+        pruned_connection_idx.resize(connection_count);
+        for (uint32_t i{0}; i < connection_count; ++i) {
+            auto const& c = genome.connections[i];
+            if (c.weight == 0.0) {
+                pruned_connection_idx[i] = Network::zero_weight_slot;
+            } else if (!reaches_output[c.to]) {
+                pruned_connection_idx[i] = Network::pruned_slot;
+            } else {
+                pruned_connection_idx[i] = static_cast<uint32_t>(pruned.connections.size());
+                pruned.connections.push_back({pruned_node_idx[c.from], pruned_node_idx[c.to], c.weight});
+                pruned.graph.createConnectionUnchecked(pruned_node_idx[c.from], pruned_node_idx[c.to]);
+            }
+        }
+
+        return pruned;
+    }
+
     [[nodiscard]]
     std::vector<uint32_t> getOrder(nt::Genome& genome) const
     {
@@ -59,9 +264,18 @@ struct NetworkGenerator
             order[i] = i;
         }
 
-        // Only sort past the inputs to ensure inputs order (even if it shouldn't change anything)
+        /* Only sort past the inputs to ensure inputs order (even if it shouldn't change anything).
+           Outputs have to be the last nodes, in their original order, even if a dead hidden node shares their depth */
         std::sort(order.begin() + genome.info.inputs, order.end(), [&genome](uint32_t a, uint32_t b) {
-            return genome.nodes[a].depth < genome.nodes[b].depth;
+            bool const a_output = genome.isOutput(a);
+            bool const b_output = genome.isOutput(b);
+            if (a_output != b_output) {
+                return b_output;
+            }
+            if (genome.nodes[a].depth != genome.nodes[b].depth) {
+                return genome.nodes[a].depth < genome.nodes[b].depth;
+            }
+            return a < b;
         });
 
         return order;
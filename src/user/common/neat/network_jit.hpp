@@ -0,0 +1,274 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "network.hpp"
+
+#if defined(__x86_64__) && defined(__linux__)
+    #define NT_NETWORK_JIT
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+
+namespace nt
+{
+
+/** Compiles a network to native code, executed instead of Network::execute.
+ *  The code is straight-line scalar SSE2, each node being computed like Network::execute does so results
+ *  are identical. None and Relu are inlined, other activations are called through their function pointer,
+ *  which also keeps the activation tier of the network.
+ *  Only available on x86-64 Linux, elsewhere compile returns false and execute falls back to the interpreter,
+ *  so callers don't need to check the result of compile.
+ */
+class NetworkJit
+{
+public:
+    NetworkJit() = default;
+
+    ~NetworkJit()
+    {
+        release();
+    }
+
+    NetworkJit(NetworkJit const&) = delete;
+    NetworkJit& operator=(NetworkJit const&) = delete;
+
+    NetworkJit(NetworkJit&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    NetworkJit& operator=(NetworkJit&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            m_code        = other.m_code;
+            m_code_size   = other.m_code_size;
+            m_constants   = std::move(other.m_constants);
+            m_values      = std::move(other.m_values);
+            m_topology_id = other.m_topology_id;
+            m_values_id   = other.m_values_id;
+            m_tier        = other.m_tier;
+            other.m_code      = nullptr;
+            other.m_code_size = 0;
+        }
+        return *this;
+    }
+
+    /** Returns false if the platform is not supported or if the executable memory cannot be allocated,
+     *  the network is then executed by the interpreter. The current mapping is reused if the code fits in it.
+     */
+    bool compile(Network const& network)
+    {
+        m_topology_id = network.topology_id;
+        m_values_id   = network.values_id;
+        m_tier        = network.activation_tier;
+#ifdef NT_NETWORK_JIT
+        std::vector<uint8_t> code;
+        emit(network, code);
+        return install(code);
+#else
+        release();
+        return false;
+#endif
+    }
+
+    [[nodiscard]]
+    bool isCompiled() const
+    {
+        return m_code != nullptr;
+    }
+
+    /// Checks if the code has been compiled from this version of the network
+    [[nodiscard]]
+    bool isUpToDate(Network const& network) const
+    {
+        return isCompiled() &&
+               m_topology_id == network.topology_id &&
+               m_values_id   == network.values_id &&
+               m_tier        == network.activation_tier;
+    }
+
+    /// Executes the compiled code, or the interpreter if the network is not compiled, and updates the network's output
+    bool execute(Network& network, std::vector<conf::RealType> const& input)
+    {
+        if (!isCompiled()) {
+            return network.execute(input);
+        }
+        if (input.size() != network.info.inputs) {
+            std::cout << "Input size mismatch, aborting" << std::endl;
+            return false;
+        }
+        reinterpret_cast<Function>(m_code)(input.data(), m_values.data(), network.output.data(), m_constants.data());
+        return true;
+    }
+
+private:
+    /// void f(input, values, output, constants)
+    using Function = void (*)(conf::RealType const*, conf::RealType*, conf::RealType*, conf::RealType const*);
+
+    uint8_t*                    m_code      = nullptr;
+    uint64_t                    m_code_size = 0;
+    /// Weights and biases, read by the code
+    std::vector<conf::RealType> m_constants;
+    /// Output value of each node
+    std::vector<conf::RealType> m_values;
+
+    uint64_t       m_topology_id = 0;
+    uint64_t       m_values_id   = 0;
+    ActivationTier m_tier        = ActivationTier::Exact;
+
+    void release()
+    {
+#ifdef NT_NETWORK_JIT
+        if (m_code) {
+            ::munmap(m_code, m_code_size);
+        }
+#endif
+        m_code      = nullptr;
+        m_code_size = 0;
+    }
+
+#ifdef NT_NETWORK_JIT
+    // Registers numbering
+    static constexpr uint8_t rbx = 3;
+    static constexpr uint8_t r12 = 12;
+    static constexpr uint8_t r13 = 13;
+    static constexpr uint8_t r14 = 14;
+    // SSE opcodes
+    static constexpr uint8_t movsd_load  = 0x10;
+    static constexpr uint8_t movsd_store = 0x11;
+    static constexpr uint8_t addsd       = 0x58;
+    static constexpr uint8_t mulsd       = 0x59;
+    // Constants stored before weights and biases
+    static constexpr uint32_t abs_mask_idx = 0;
+    static constexpr uint32_t half_idx     = 1;
+
+    /** Arguments are moved to callee-saved registers to survive the activations calls
+     *  rbx: input, r12: values, r13: output, r14: constants
+     */
+    void emit(Network const& network, std::vector<uint8_t>& code)
+    {
+        uint32_t const node_count   = network.info.getNodeCount();
+        uint32_t const first_output = network.info.inputs + network.info.hidden;
+        m_values.assign(node_count, 0.0);
+        m_constants.clear();
+        uint64_t const abs_mask = 0x7FFFFFFFFFFFFFFF;
+        m_constants.push_back(0.0);
+        std::memcpy(&m_constants[abs_mask_idx], &abs_mask, sizeof(abs_mask));
+        m_constants.push_back(0.5);
+
+        // Prologue, the stack is aligned to 16 bytes for the calls
+        code.insert(code.end(), {0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56});
+        code.insert(code.end(), {0x48, 0x83, 0xEC, 0x08});
+        // mov rbx, rdi / mov r12, rsi / mov r13, rdx / mov r14, rcx
+        code.insert(code.end(), {0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4, 0x49, 0x89, 0xD5, 0x49, 0x89, 0xCE});
+
+        for (uint32_t i{0}; i < node_count; ++i) {
+            if (i < network.info.inputs) {
+                emitSse(code, movsd_load, 0, rbx, i);
+            } else {
+                // xorpd xmm0, xmm0
+                code.insert(code.end(), {0x66, 0x0F, 0x57, 0xC0});
+            }
+            for (uint32_t k{network.incoming_start[i]}; k < network.incoming_start[i + 1]; ++k) {
+                Network::Incoming const& in = network.incoming[k];
+                emitSse(code, movsd_load, 1, r12, in.from);
+                emitSse(code, mulsd, 1, r14, addConstant(in.weight));
+                // addsd xmm0, xmm1
+                code.insert(code.end(), {0xF2, 0x0F, 0x58, 0xC1});
+            }
+            emitSse(code, addsd, 0, r14, addConstant(network.node_biases[i]));
+
+            if (network.node_activations[i] == Activation::Relu) {
+                // (x + |x|) * 0.5
+                emitSse(code, movsd_load, 1, r14, abs_mask_idx);
+                // andpd xmm1, xmm0 / addsd xmm0, xmm1
+                code.insert(code.end(), {0x66, 0x0F, 0x54, 0xC8, 0xF2, 0x0F, 0x58, 0xC1});
+                emitSse(code, mulsd, 0, r14, half_idx);
+            } else if (network.node_activations[i] != Activation::None) {
+                // mov rax, activation / call rax
+                auto const address = reinterpret_cast<uint64_t>(network.getActivation(i));
+                code.insert(code.end(), {0x48, 0xB8});
+                for (uint32_t b{0}; b < 8; ++b) {
+                    code.push_back(static_cast<uint8_t>(address >> (8 * b)));
+                }
+                code.insert(code.end(), {0xFF, 0xD0});
+            }
+
+            emitSse(code, movsd_store, 0, r12, i);
+            if (i >= first_output) {
+                emitSse(code, movsd_store, 0, r13, i - first_output);
+            }
+        }
+
+        // Epilogue
+        code.insert(code.end(), {0x48, 0x83, 0xC4, 0x08});
+        code.insert(code.end(), {0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3});
+    }
+
+    /// op xmm, [base + 8 * idx], with op a scalar double instruction (F2 0F prefix)
+    static void emitSse(std::vector<uint8_t>& code, uint8_t opcode, uint8_t xmm, uint8_t base, uint32_t idx)
+    {
+        code.push_back(0xF2);
+        if (base >= 8) {
+            code.push_back(0x41);
+        }
+        code.push_back(0x0F);
+        code.push_back(opcode);
+        // Mod 10: 32 bits displacement
+        code.push_back(static_cast<uint8_t>(0x80 | (xmm << 3) | (base & 7)));
+        if ((base & 7) == 4) {
+            // SIB required by r12
+            code.push_back(0x24);
+        }
+        uint32_t const displacement = idx * sizeof(conf::RealType);
+        for (uint32_t b{0}; b < 4; ++b) {
+            code.push_back(static_cast<uint8_t>(displacement >> (8 * b)));
+        }
+    }
+
+    uint32_t addConstant(conf::RealType value)
+    {
+        m_constants.push_back(value);
+        return static_cast<uint32_t>(m_constants.size() - 1);
+    }
+
+    bool install(std::vector<uint8_t> const& code)
+    {
+        // Mutations mostly change the weights, reuse the mapping instead of allocating new pages
+        if (m_code && code.size() <= m_code_size) {
+            // The memory is never writable and executable at the same time
+            if (::mprotect(m_code, m_code_size, PROT_READ | PROT_WRITE) == 0) {
+                std::memcpy(m_code, code.data(), code.size());
+                if (::mprotect(m_code, m_code_size, PROT_READ | PROT_EXEC) == 0) {
+                    return true;
+                }
+            }
+        }
+        release();
+
+        auto const page_size = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+        uint64_t const size  = ((code.size() + page_size - 1) / page_size) * page_size;
+        void* const memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            return false;
+        }
+        std::memcpy(memory, code.data(), code.size());
+        // The memory is never writable and executable at the same time
+        if (::mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+            ::munmap(memory, size);
+            return false;
+        }
+        m_code      = static_cast<uint8_t*>(memory);
+        m_code_size = size;
+        return true;
+    }
+#endif
+};
+
+}
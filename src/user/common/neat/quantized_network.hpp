@@ -0,0 +1,154 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "network.hpp"
+
+
+namespace nt
+{
+
+/** Integer version of a Network, with the same interface.
+ *  Each node value is quantized with its own scale, derived from a bound of the value computed
+ *  from the inputs range. The scales of the sources are folded in the weights, which are then
+ *  quantized with one scale per node. Products are accumulated as integers and dequantized before the activation.
+ *
+ * @tparam TInt int8_t or int16_t
+ */
+template<typename TInt>
+struct QuantizedNetwork
+{
+    static_assert(std::is_same_v<TInt, int8_t> || std::is_same_v<TInt, int16_t>, "Only int8 and int16 are supported");
+
+    /// Wide enough to sum the products of the largest supported networks without overflow
+    using Accumulator = std::conditional_t<sizeof(TInt) == 1, int32_t, int64_t>;
+
+    static constexpr conf::RealType max_int   = static_cast<conf::RealType>(std::numeric_limits<TInt>::max());
+    /// Bounds of unbounded activations are capped to keep a usable resolution
+    static constexpr conf::RealType max_bound = 1024.0;
+
+    Network::Info               info;
+    std::vector<conf::RealType> output;
+
+    /// Incoming connections of each node, same order as Network
+    std::vector<uint32_t>       incoming_start;
+    std::vector<uint32_t>       sources;
+    std::vector<TInt>           weights;
+    /// Per node data
+    std::vector<conf::RealType> biases;
+    std::vector<ActivationPtr>  activations;
+    std::vector<conf::RealType> bounds;
+    std::vector<conf::RealType> value_scales;
+    std::vector<conf::RealType> weight_scales;
+    /// Quantized output value of each node
+    std::vector<TInt>           values;
+
+    /// Ids of the network the quantized version has been built from
+    uint64_t topology_id = 0;
+    uint64_t values_id   = 0;
+
+    /** Quantizes the network
+     *
+     * @param network The network to quantize, its incoming connections have to be built
+     * @param input_range Inputs are expected to be in [-input_range, input_range], values outside are clamped
+     */
+    void build(Network const& network, conf::RealType input_range = 1.0)
+    {
+        info        = network.info;
+        topology_id = network.topology_id;
+        values_id   = network.values_id;
+        output.resize(info.outputs);
+
+        uint32_t const node_count = info.getNodeCount();
+        incoming_start = network.incoming_start;
+        sources.resize(network.incoming.size());
+        weights.resize(network.incoming.size());
+        biases.resize(node_count);
+        activations.resize(node_count);
+        bounds.resize(node_count);
+        value_scales.resize(node_count);
+        weight_scales.resize(node_count);
+        values.assign(node_count, 0);
+
+        for (uint32_t i{0}; i < node_count; ++i) {
+            biases[i]      = network.node_biases[i];
+            activations[i] = network.getActivation(i);
+
+            // Sources are always computed before the node, their bounds are known
+            conf::RealType sum_bound  = std::abs(biases[i]) + ((i < info.inputs) ? input_range : 0.0);
+            conf::RealType max_weight = 0.0;
+            for (uint32_t k{incoming_start[i]}; k < incoming_start[i + 1]; ++k) {
+                Network::Incoming const& in = network.incoming[k];
+                sum_bound += std::abs(in.weight) * bounds[in.from];
+                max_weight = std::max(max_weight, std::abs(in.weight) * value_scales[in.from]);
+            }
+            bounds[i]        = std::max(getActivationBound(activations[i], sum_bound), std::numeric_limits<conf::RealType>::min());
+            value_scales[i]  = bounds[i] / max_int;
+            weight_scales[i] = (max_weight > 0.0) ? max_weight / max_int : 1.0;
+            for (uint32_t k{incoming_start[i]}; k < incoming_start[i + 1]; ++k) {
+                Network::Incoming const& in = network.incoming[k];
+                sources[k] = in.from;
+                weights[k] = static_cast<TInt>(std::lround(in.weight * value_scales[in.from] / weight_scales[i]));
+            }
+        }
+    }
+
+    /// Checks if the quantized network has been built from this version of the network
+    [[nodiscard]]
+    bool isUpToDate(Network const& network) const
+    {
+        return !activations.empty() && topology_id == network.topology_id && values_id == network.values_id;
+    }
+
+    bool execute(std::vector<conf::RealType> const& input)
+    {
+        if (input.size() != info.inputs) {
+            std::cout << "Input size mismatch, aborting" << std::endl;
+            return false;
+        }
+
+        uint32_t const node_count   = info.getNodeCount();
+        uint32_t const first_output = info.inputs + info.hidden;
+        for (uint32_t i{0}; i < node_count; ++i) {
+            Accumulator sum = 0;
+            for (uint32_t k{incoming_start[i]}; k < incoming_start[i + 1]; ++k) {
+                sum += static_cast<Accumulator>(values[sources[k]]) * static_cast<Accumulator>(weights[k]);
+            }
+            conf::RealType const input_value = (i < info.inputs) ? input[i] : 0.0;
+            conf::RealType const value       = activations[i](static_cast<conf::RealType>(sum) * weight_scales[i] + input_value + biases[i]);
+            values[i] = quantizeValue(i, value);
+            if (i >= first_output) {
+                // Outputs are not quantized
+                output[i - first_output] = value;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]]
+    std::vector<conf::RealType> const& getResult() const
+    {
+        return output;
+    }
+
+    [[nodiscard]]
+    TInt quantizeValue(uint32_t node_idx, conf::RealType value) const
+    {
+        conf::RealType const clamped = std::clamp(value, -bounds[node_idx], bounds[node_idx]);
+        return static_cast<TInt>(std::lround(clamped / value_scales[node_idx]));
+    }
+
+    /// Bound of the absolute value of the activation's output when the absolute value of its input is lower than sum_bound
+    [[nodiscard]]
+    static conf::RealType getActivationBound(ActivationPtr activation, conf::RealType sum_bound)
+    {
+        // All activations are monotonic
+        return std::min(std::max(std::abs(activation(sum_bound)), std::abs(activation(-sum_bound))), max_bound);
+    }
+};
+
+}
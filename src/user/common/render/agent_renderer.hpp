@@ -17,6 +17,8 @@ struct AgentRenderer
     };
 
     uint8_t alpha = 50;
+    float   radius  = 10.0f;
+    float   outline = 2.0f;
 
     sf::VertexArray va_links;
     Cart cart;
@@ -52,14 +54,10 @@ struct AgentRenderer
         return sf::Color::White;
     }
 
-    void renderAgent(pez::render::Context& context, Agent const& agent, Mode mode)
+    /// Writes the links geometry, can be called from a worker thread
+    void prepareAgent(Agent const& agent, Mode mode)
     {
         sf::Color const color = getColor(mode);
-
-        float const radius{10.0f};
-        float const outline{2.0f};
-
-        // Links
         uint32_t i{0};
         for (auto const& o : agent.system.objects) {
             common::Utils::generateLine(va_links,
@@ -71,6 +69,14 @@ struct AgentRenderer
                                         2.0f * (outline + radius));
             ++i;
         }
+    }
+
+    /// Links are the ones written by the last prepareAgent
+    void renderAgent(pez::render::Context& context, Agent const& agent, Mode mode)
+    {
+        sf::Color const color = getColor(mode);
+
+        // Links
         context.draw(va_links);
 
         // Cart
@@ -79,7 +85,7 @@ struct AgentRenderer
         cart.render(context);
 
         // Objects
-        i = 0;
+        uint32_t i{0};
         sf::CircleShape object{radius};
         object.setOrigin(radius, radius);
         object.setFillColor(getJointColor(mode, i));
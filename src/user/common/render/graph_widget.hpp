@@ -6,6 +6,14 @@
 
 struct GraphWidget
 {
+    /// Value index (scale-X) or value (scale-Y) of a tick, and its position along the axis
+    template<typename TValue>
+    struct Tick
+    {
+        TValue value;
+        float  position;
+    };
+
     float const background_radius = 20.0f;
     float const title_height      = 10.0f;
     Vec2 const  padding           = Vec2{background_radius, 1.5f * background_radius};
@@ -30,6 +38,12 @@ struct GraphWidget
     float           last_value = 0.0f;
     uint32_t        tick_x_period = 20;
 
+    /// Filled by prepare, used by the next render
+    std::vector<Tick<uint32_t>> x_ticks;
+    std::vector<Tick<float>>    y_ticks;
+    uint8_t                     y_label_decimals = 0;
+    bool                        prepared         = false;
+
     std::function<std::string(uint32_t)> label_callback;
     std::function<std::string(float)>    current_value_callback;
 
@@ -102,42 +116,34 @@ struct GraphWidget
         title.setPosition(position + Vec2{outline + 0.75f * padding.x, 0.35f * padding.y});
     }
 
-    void render(pez::render::Context& context)
+    /** Builds the scale geometry and the ticks positions, without drawing nor using the font.
+     *  Only this widget's buffers are written, widgets can be prepared in parallel.
+     */
+    void prepare()
     {
-        sf::Text scale_label;
-        scale_label.setFont(*font);
-        scale_label.setCharacterSize(18);
-        scale_label.setFillColor(scale_color);
-        scale_label.setScale(font_scale, font_scale);
-
-        // Render background
-        outline_background.renderHud(context);
-        background.renderHud(context);
-
-        // Render scale-X
         va_scale.clear();
+        x_ticks.clear();
+        y_ticks.clear();
+
+        // Scale-X, only the ticks are visited
         uint32_t const count = chart.values.getCount();
-        float const dx = chart.size.x / float(count - 1);
-        chart.values.foreach([&](uint32_t i, float v) {
-            float const x = to<float>(i) * dx + position.x + padding.x + outline;
+        if (count) {
+            uint32_t const first_i = chart.getGlobalValueIndex(0);
+            uint32_t const first_tick = ((first_i + tick_x_period - 1) / tick_x_period) * tick_x_period;
+            for (uint32_t current_i{first_tick}; current_i < first_i + count; current_i += tick_x_period) {
+                float const x = chart.position.x + chart.getValueX(current_i - first_i);
 
-            uint32_t const current_i = chart.getGlobalValueIndex(i);
-            if (current_i % tick_x_period == 0) {
                 sf::Vertex vertex{};
                 vertex.color = scale_color;
                 vertex.position = {x, position.y + padding.y + title_height + outline};
                 va_scale.append(vertex);
                 vertex.position = {x, position.y + size.y - padding.y - outline};
                 va_scale.append(vertex);
-
-                scale_label.setString(label_callback(current_i));
-                float const label_width = scale_label.getGlobalBounds().width;
-                scale_label.setPosition(x - label_width * 0.5f, position.y + size.y - padding.y - outline);
-                context.drawDirect(scale_label);
+                x_ticks.push_back({current_i, x});
             }
-        });
+        }
 
-        // Render scale-Y
+        // Scale-Y
         uint32_t const tick_count  = 4;
         float const    y_width      = std::abs(chart.extremes.y - chart.extremes.x);
         float const    tick_height_raw = y_width / float(tick_count);
@@ -147,28 +153,57 @@ struct GraphWidget
         for (uint32_t i{0}; i < ticks; ++i) {
             sf::Vertex vertex{};
             vertex.color = scale_color;
-            float const y = chart.getScaledY(lower_tick + to<float>(i) * tick_height);
+            float const value = lower_tick + to<float>(i) * tick_height;
+            float const y = chart.getScaledY(value);
             if (y >= chart.position.y) {
                 vertex.position = {position.x + padding.x + outline, y};
                 va_scale.append(vertex);
                 vertex.position = {position.x + inner_size.x, y};
                 va_scale.append(vertex);
+                y_ticks.push_back({value, y});
             }
         }
+        y_label_decimals = y_width < 10.0f;
+        prepared = true;
+    }
+
+    void render(pez::render::Context& context)
+    {
+        // Widgets that are not prepared by their renderer are prepared here
+        if (!prepared) {
+            prepare();
+        }
+        prepared = false;
+
+        sf::Text scale_label;
+        scale_label.setFont(*font);
+        scale_label.setCharacterSize(18);
+        scale_label.setFillColor(scale_color);
+        scale_label.setScale(font_scale, font_scale);
+
+        // Render background
+        outline_background.renderHud(context);
+        background.renderHud(context);
+
+        // Render scale-X labels
+        for (auto const& tick : x_ticks) {
+            scale_label.setString(label_callback(tick.value));
+            float const label_width = scale_label.getGlobalBounds().width;
+            scale_label.setPosition(tick.position - label_width * 0.5f, position.y + size.y - padding.y - outline);
+            context.drawDirect(scale_label);
+        }
 
         context.drawDirect(va_scale);
 
         // Render chart
         chart.render(context);
 
-        for (uint32_t i{0}; i < ticks; ++i) {
-            float const y = chart.getScaledY(lower_tick + to<float>(i) * tick_height);
-            if (y >= chart.position.y) {
-                scale_label.setString(toString(lower_tick + to<float>(i) * tick_height, y_width < 10.0f));
-                auto const bounds = scale_label.getGlobalBounds();
-                scale_label.setPosition(position.x + size.x - padding.x - bounds.width - 5.0f, y);
-                context.drawDirect(scale_label);
-            }
+        // Render scale-Y labels
+        for (auto const& tick : y_ticks) {
+            scale_label.setString(toString(tick.value, y_label_decimals));
+            auto const bounds = scale_label.getGlobalBounds();
+            scale_label.setPosition(position.x + size.x - padding.x - bounds.width - 5.0f, tick.position);
+            context.drawDirect(scale_label);
         }
 
         if (chart.values.getCount()) {
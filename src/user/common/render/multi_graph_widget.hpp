@@ -27,6 +27,8 @@ struct MultiGraphWidget
     std::vector<Vec2>        points;
     std::vector<SmoothFloat> width;
     sf::VertexArray          va_line;
+    /// When reached, the older half of the points is decimated
+    uint32_t                 max_points_count = 2048;
 
     explicit
     MultiGraphWidget(Vec2 size_, Vec2 position_ = {})
@@ -64,12 +66,16 @@ struct MultiGraphWidget
         width.clear();
         extremes_x = {-1.0f, 1.0f};
         extremes_y = {-1.0f, 1.0f};
+        va_line.clear();
     }
 
     void addPoint(Vec2 pt)
     {
         extremes_x = {std::min(extremes_x.x, pt.x), std::max(extremes_x.y, pt.x)};
         extremes_y = {std::min(extremes_y.x, pt.y), std::max(extremes_y.y, pt.y)};
+        if (points.size() >= max_points_count) {
+            decimate();
+        }
         points.push_back(pt);
         auto& w = width.emplace_back();
         w.setValueInstant(4.0f);
@@ -97,6 +103,29 @@ struct MultiGraphWidget
         title.setPosition(position + Vec2{outline + 0.75f * padding.x, 0.35f * padding.y});
     }
 
+    /// Builds the line, only this widget's buffers are written so widgets can be prepared in parallel
+    void prepare()
+    {
+        if (points.size() < 2) {
+            va_line.clear();
+            return;
+        }
+        va_line.resize(2 * points.size() - 2);
+        Vec2 last = remap_point(points[0]);
+        for (uint32_t i{1}; i < points.size(); ++i) {
+            Vec2 const current = remap_point(points[i]);
+            Vec2 const d = current - last;
+            Vec2 const n = MathVec2::normalize(MathVec2::normal(d));
+            float const w = width[i].get();
+            va_line[2 * (i - 1) + 0].position = current + w * n;
+            va_line[2 * (i - 1) + 1].position = current - w * n;
+            va_line[2 * (i - 1) + 0].color = color;
+            va_line[2 * (i - 1) + 1].color = color;
+            last = current;
+        }
+    }
+
+    /// Draws the line built by the last prepare
     void render(pez::render::Context& context)
     {
         // Background
@@ -104,27 +133,9 @@ struct MultiGraphWidget
         background.renderHud(context);
 
         // Line
-        sf::Transform transform;
-        transform.translate(position);
-        va_line.resize(2 * points.size() - 2);
-
-        if (points.size() > 1) {
-            Vec2 last = remap_point(points[0]);
-            uint32_t i{0};
-            for (auto const& pt: points) {
-                if (i > 0) {
-                    Vec2 const current = remap_point(pt);
-                    Vec2 const d = current - last;
-                    Vec2 const n = MathVec2::normalize(MathVec2::normal(d));
-                    float const w = width[i].get();
-                    va_line[2 * (i - 1) + 0].position = current + w * n;
-                    va_line[2 * (i - 1) + 1].position = current - w * n;
-                    va_line[2 * (i - 1) + 0].color = color;
-                    va_line[2 * (i - 1) + 1].color = color;
-                    last = current;
-                }
-                ++i;
-            }
+        if (va_line.getVertexCount()) {
+            sf::Transform transform;
+            transform.translate(position);
             context.drawDirect(va_line, transform);
         }
 
@@ -133,6 +144,23 @@ struct MultiGraphWidget
         context.drawDirect(title);
     }
 
+    /// Keeps one point out of two in the older half
+    void decimate()
+    {
+        uint32_t const half = to<uint32_t>(points.size()) / 2;
+        uint32_t kept = 0;
+        for (uint32_t i{0}; i < points.size(); ++i) {
+            if (i < half && (i & 1)) {
+                continue;
+            }
+            points[kept] = points[i];
+            width[kept]  = width[i];
+            ++kept;
+        }
+        points.resize(kept);
+        width.resize(kept);
+    }
+
     void setTitle(std::string const& title_)
     {
         title.setString(title_);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cassert>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "engine/common/utils.hpp"
@@ -61,6 +63,11 @@ struct NetworkRenderer
 
     float margin = node_radius + 5.0f;
     nt::Network const* network{nullptr};
+    /// Copy of the network when it is not kept alive by the caller, see setNetwork
+    nt::Network        owned_network;
+    /// Ids of the network the layout and the weights have been built from
+    uint64_t           topology_id = 0;
+    uint64_t           values_id   = 0;
     std::vector<DrawableNode>       nodes;
     std::vector<DrawableConnection> connections;
 
@@ -69,18 +76,28 @@ struct NetworkRenderer
 
     sf::VertexArray connections_va;
 
+    /// Computed with the layout to avoid measuring texts each frame
+    std::vector<Vec2> label_positions;
+    std::string       info_string;
+    bool              render_info = false;
+
     float background_outline_thickness = 5.0f;
     float background_padding           = 20.0f;
 
     Card background;
     Card background_outline;
+    /// Background, labels and info, only rendered again when the layout or the position changes
+    pez::render::Layer static_layer;
 
     bool disable_info = false;
 
     NetworkRenderer()
         : background({}, 20.0f, {50, 50, 50})
         , background_outline({}, 20.0f + background_outline_thickness, sf::Color::White)
-    {}
+    {
+        // Everything in the layer is drawn in window pixels, panning or zooming the viewport does not change it
+        static_layer.screen_space = true;
+    }
 
     void setFont(sf::Font& font)
     {
@@ -89,9 +106,38 @@ struct NetworkRenderer
         text_label.setFillColor(sf::Color::White);
     }
 
+    /// Checks if the layout or the weights have to be rebuilt to render this version of a network
+    [[nodiscard]]
+    bool isOutdated(uint64_t topology_id_, uint64_t values_id_) const
+    {
+        return !network || topology_id != topology_id_ || values_id != values_id_;
+    }
+
+    /** Takes ownership of the network, the layout is only rebuilt if its topology changed
+     *
+     * @return true if the layout, and thus the size, changed
+     */
+    bool setNetwork(nt::Network&& nw)
+    {
+        bool const new_topology = !network || nw.topology_id == 0 || nw.topology_id != topology_id;
+        owned_network = std::move(nw);
+        if (new_topology) {
+            initialize(owned_network);
+        } else {
+            network   = &owned_network;
+            values_id = owned_network.values_id;
+            updateWeights();
+        }
+        return new_topology;
+    }
+
+    /// Builds the layout, the network has to outlive the renderer or to be replaced before the next update
     void initialize(nt::Network const& nw)
     {
-        network = &nw;
+        network     = &nw;
+        topology_id = nw.topology_id;
+        values_id   = nw.values_id;
+        static_layer.invalidate();
 
         architecture.reset();
         nodes.clear();
@@ -111,11 +157,11 @@ struct NetworkRenderer
         nodes.resize(nw.info.getNodeCount());
         for (uint32_t i{0}; i < nw.info.getNodeCount(); ++i) {
             auto& node = nodes[i];
-            auto const& n = nw.slots[i].node;
-            node.layer      = n.depth;
+            uint32_t const depth = nw.node_depths[i];
+            node.layer      = depth;
             /* Little hack to ensure the output layer is last even with no connections.
              * A better solution would be to do this directly when building the network. */
-            if (i >= nw.info.inputs && i < nw.info.inputs + nw.info.outputs && n.depth == 0) {
+            if (i >= nw.info.inputs && i < nw.info.inputs + nw.info.outputs && depth == 0) {
                 node.layer = 1;
             }
             node.position.x = total_padding + label_offset + to<float>(node.layer) * (node_radius * 2.0f + node_spacing.x);
@@ -147,13 +193,13 @@ struct NetworkRenderer
             uint32_t connection_idx = 0;
             uint32_t const node_count = nw.info.getNodeCount();
             for (uint32_t i{0}; i < node_count; ++i) {
-                const uint32_t connection_count = nw.getNode(i).connection_count;
+                const uint32_t connection_count = nw.node_connection_counts[i];
                 //std::cout << "Node " << i + 1 << "/" << nw.info.getNodeCount() << " with " << connection_count << " connections" << std::endl;
                 for (uint32_t k{0}; k < connection_count; ++k) {
                     //std::cout << "Create connection " << connection_idx << std::endl;
                     auto& c = connections.emplace_back();
                     c.start = nodes[i].position;
-                    c.end   = nodes[nw.getConnection(connection_idx).to].position;
+                    c.end   = nodes[nw.connections[connection_idx].to].position;
                     ++connection_idx;
                 }
             }
@@ -161,19 +207,39 @@ struct NetworkRenderer
             assert(connection_idx == network->connection_count);
         }
 
-        {
-            connections_va = sf::VertexArray(sf::Quads, 4 * connections.size());
-            uint32_t i{0};
-            for (auto const& c : connections) {
-                common::Utils::generateLine(connections_va, 4 * i, c.start, c.end, 2.0f, sf::Color::White);
-                ++i;
-            }
+        connections_va = sf::VertexArray(sf::Quads, 4 * connections.size());
+        updateWeights();
+
+        label_positions.clear();
+        float label_y = 4.0f;
+        for (auto const& l : labels) {
+            text_label.setString(l);
+            float const width = text_label.getGlobalBounds().width;
+            label_positions.emplace_back(total_padding + label_offset - width - 12.0f, total_padding + label_y);
+            label_y += 2.0f * node_radius + node_spacing.y;
+        }
+
+        info_string = "Hidden nodes: " + toString(nw.info.hidden) + "\nConnections : " + toString(nw.connection_count);
+        text_label.setString(info_string);
+        render_info = !disable_info && (text_label.getGlobalBounds().width < (size.x - 50.0f));
+    }
+
+    /// Connections widths and colors from their weights, used when values are not recorded
+    void updateWeights()
+    {
+        for (uint32_t i{0}; i < network->connection_count; ++i) {
+            auto const& c = connections[i];
+            float const weight = to<float>(network->connections[i].weight);
+            float const width  = std::max(1.0f, std::min(node_radius * 0.5f, std::abs(weight)));
+            sf::Color const color = (weight > 0.0f) ? sf::Color{188, 226, 158} : sf::Color{255, 135, 135};
+            common::Utils::generateLine(connections_va, 4 * i, c.start, c.end, width, color);
         }
     }
 
     void setPosition(Vec2 pos)
     {
         position = pos;
+        static_layer.invalidate();
         // Background
         background.position = position + Vec2{background_outline_thickness, background_outline_thickness};
         background.size     = size - 2.0f * Vec2{background_outline_thickness, background_outline_thickness};
@@ -191,12 +257,13 @@ struct NetworkRenderer
             return;
         }
 
-        background_outline.renderHud(context);
-        background.renderHud(context);
-
         sf::Transform transform;
         transform.translate(position);
 
+        context.drawLayer(static_layer, [&] {
+            renderStatic(context, transform);
+        });
+
         context.drawDirect(connections_va, transform);
 
         float const out_radius = node_radius + 3.0f;
@@ -222,14 +289,18 @@ struct NetworkRenderer
 
             ++node_idx;
         }
+    }
+
+    /// Background, labels and info, they do not overlap connections and nodes
+    void renderStatic(pez::render::Context& context, sf::Transform const& transform)
+    {
+        background_outline.renderHud(context);
+        background.renderHud(context);
 
         float const total_padding = background_outline_thickness + background_padding;
-        float label_y = 4.0f;
-        for (auto const& l : labels) {
-            text_label.setString(l);
-            float const width = text_label.getGlobalBounds().width;
-            text_label.setPosition(total_padding + label_offset - width - 12.0f, total_padding + label_y);
-            label_y += 2.0f * node_radius + node_spacing.y;
+        for (uint32_t i{0}; i < label_positions.size(); ++i) {
+            text_label.setString(labels[i]);
+            text_label.setPosition(label_positions[i]);
             context.drawDirect(text_label, transform);
         }
 
@@ -242,9 +313,8 @@ struct NetworkRenderer
             context.drawDirect(va_line, transform);
 
             text_label.setPosition(total_padding, total_padding + max_layer_height + 1.5f * node_radius);
-            text_label.setString("Hidden nodes: " + toString(network->info.hidden) + "\nConnections : " +
-                                 toString(network->connection_count));
-            if (text_label.getGlobalBounds().width < (size.x - 50.0f)) {
+            text_label.setString(info_string);
+            if (render_info) {
                 context.drawDirect(text_label, transform);
             }
         }
@@ -259,25 +329,25 @@ struct NetworkRenderer
         for (uint32_t i{0}; i < network->connection_count; ++i) {
             auto& c = connections[i];
 
-            c.width = to<float>(network->getConnection(i).value) * 20.0f;
+            c.width = to<float>(network->connection_values[i]) * 20.0f;
             float const sign = Math::sign(c.width.get());
             float const width = std::max(1.0f, std::min(node_radius, std::abs(c.width.get())));
 
             sf::Color const color = (sign > 0.0f) ? sf::Color{188, 226, 158} : sf::Color{255, 135, 135};
             common::Utils::generateLine(connections_va, 4 * i, c.start, c.end, width, color);
-            ++i;
         }
 
         {
-            network->foreachNode([this](nt::Network::Node const& n, uint32_t i) {
+            uint32_t const node_count = network->info.getNodeCount();
+            for (uint32_t i{0}; i < node_count; ++i) {
                 float value;
                 if (i < network->info.inputs) {
-                    value = to<float>(n.sum);
+                    value = to<float>(network->node_sums[i]);
                 } else {
-                    value = to<float>(n.getValue());
+                    value = to<float>(network->values[i]);
                 }
                 nodes[i].value.setValueInstant(Math::clampAmplitude(value, 1.0f));
-            });
+            }
         }
     }
 
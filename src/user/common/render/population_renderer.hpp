@@ -0,0 +1,242 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "engine/engine.hpp"
+
+#include "user/common/configuration.hpp"
+#include "user/common/agent.hpp"
+#include "user/common/render/agent_renderer.hpp"
+#include "user/common/render/utils.hpp"
+
+
+/** Renders agents as ghosts, like AgentRenderer in Ghost mode, with a single draw call.
+ *  All the quads are stored in one vertex array textured by an atlas holding a disc for the joints,
+ *  the wheel texture and a white texel for the untextured shapes.
+ *  Colors and texture coordinates only change with the agent count, each frame only positions are
+ *  written, in parallel on the thread pool.
+ */
+struct PopulationRenderer
+{
+    static constexpr uint32_t joint_count = conf::sim::segments_count + 1;
+    /// Links, cart (body, 2 wheel struts, hub, 4 wheels), joints outlines and fills
+    static constexpr uint32_t link_quads         = conf::sim::segments_count;
+    static constexpr uint32_t cart_quads         = 8;
+    static constexpr uint32_t joint_quads        = 2 * joint_count;
+    static constexpr uint32_t quads_per_agent    = link_quads + cart_quads + joint_quads;
+    static constexpr uint32_t vertices_per_agent = 4 * quads_per_agent;
+
+    // Same dimensions as AgentRenderer and Cart
+    static constexpr float joint_radius   = 10.0f;
+    static constexpr float joint_outline  = 2.0f;
+    static constexpr float link_width     = 4.0f;
+    static constexpr float wheel_radius   = 12.0f;
+    static constexpr float bottom_scale   = 0.75f;
+    static constexpr float cart_width     = 32.0f;
+    static constexpr float hub_radius     = 3.0f;
+
+    static constexpr uint32_t disc_size = 64;
+    static constexpr uint32_t padding   = 2;
+
+    sf::Texture     atlas;
+    sf::VertexArray va;
+    uint32_t        agent_count = 0;
+
+    /// Atlas regions, in pixels
+    sf::FloatRect white_rect;
+    sf::FloatRect disc_rect;
+    sf::FloatRect wheel_rect;
+
+    /// Cart offset, taken from the agent renderer
+    Vec2 cart_offset = {25.0f, 1.0f};
+    /// Wheels rotation of each agent
+    std::vector<float> carts_x;
+    std::vector<float> carts_delta_x;
+
+    sf::Color color;
+    std::array<sf::Color, joint_count> joint_colors;
+
+    PopulationRenderer()
+        : va{sf::PrimitiveType::Quads}
+    {}
+
+    void initialize(AgentRenderer const& agent_renderer)
+    {
+        cart_offset = agent_renderer.cart.offset;
+        color       = agent_renderer.getColor(AgentRenderer::Mode::Ghost);
+        for (uint32_t i{0}; i < joint_count; ++i) {
+            joint_colors[i] = agent_renderer.getJointColor(AgentRenderer::Mode::Ghost, i);
+        }
+        createAtlas(pez::resources::getTexture("wheel").copyToImage());
+        agent_count = 0;
+    }
+
+    /** Writes the quads of all agents
+     *
+     * @param count Number of agents
+     * @param get_agent Callback returning the Agent const& of an index, called from the thread pool
+     */
+    template<typename TGetAgent>
+    void update(uint32_t count, TGetAgent&& get_agent)
+    {
+        if (count != agent_count) {
+            resize(count);
+        }
+        sf::Vertex* const vertices = count ? &va[0] : nullptr;
+        pez::core::getSingleton<tp::ThreadPool>().dispatch(count, [&](uint32_t start, uint32_t end) {
+            for (uint32_t i{start}; i < end; ++i) {
+                writeAgent(i, get_agent(i), vertices + i * vertices_per_agent);
+            }
+        });
+    }
+
+    void render(pez::render::Context& context)
+    {
+        if (!agent_count) {
+            return;
+        }
+        sf::RenderStates states;
+        states.texture = &atlas;
+        context.draw(va, states);
+    }
+
+private:
+    void resize(uint32_t count)
+    {
+        agent_count = count;
+        va.resize(static_cast<uint64_t>(count) * vertices_per_agent);
+        carts_x.assign(count, 0.0f);
+        carts_delta_x.assign(count, 0.0f);
+
+        for (uint32_t i{0}; i < count; ++i) {
+            sf::Vertex* quad = &va[static_cast<uint64_t>(i) * vertices_per_agent];
+            for (uint32_t k{0}; k < link_quads + 3; ++k) {
+                setQuadStyle(quad, white_rect, color);
+                quad += 4;
+            }
+            setQuadStyle(quad, disc_rect, color);
+            quad += 4;
+            for (uint32_t k{0}; k < 4; ++k) {
+                setQuadStyle(quad, wheel_rect, color);
+                quad += 4;
+            }
+            for (uint32_t k{0}; k < joint_count; ++k) {
+                setQuadStyle(quad, disc_rect, color);
+                setQuadStyle(quad + 4, disc_rect, joint_colors[k]);
+                quad += 8;
+            }
+        }
+    }
+
+    void writeAgent(uint32_t i, Agent const& agent, sf::Vertex* quad)
+    {
+        // Links
+        for (auto const& o : agent.system.objects) {
+            common::Utils::generateLine(quad, Vec2{o.getWorldPosition(0)}, Vec2{o.getWorldPosition(1)}, link_width, color, 2.0f * (joint_outline + joint_radius));
+            quad += 4;
+        }
+
+        // Cart
+        Vec2 const position{agent.system.drag_constraints[0].target};
+        carts_delta_x[i] += position.x - carts_x[i];
+        carts_x[i]        = position.x;
+        float const angle = carts_delta_x[i] / wheel_radius;
+
+        Vec2 const wheel_1_position = position + Vec2{ cart_offset.x, cart_offset.y}        + Vec2{0.0f, wheel_radius};
+        Vec2 const wheel_2_position = position + Vec2{-cart_offset.x, cart_offset.y}        + Vec2{0.0f, wheel_radius};
+        Vec2 const wheel_3_position = position + Vec2{ 1.5f * cart_offset.x, -cart_offset.y} - Vec2{0.0f, wheel_radius * bottom_scale};
+        Vec2 const wheel_4_position = position + Vec2{-1.5f * cart_offset.x, -cart_offset.y} - Vec2{0.0f, wheel_radius * bottom_scale};
+
+        common::Utils::generateLine(quad, position - Vec2{cart_width, 0.0f}, position + Vec2{cart_width, 0.0f}, 6.0f, color);
+        common::Utils::generateLine(quad + 4, wheel_1_position, wheel_3_position, 8.0f, color);
+        common::Utils::generateLine(quad + 8, wheel_2_position, wheel_4_position, 8.0f, color);
+        setQuadPosition(quad + 12, position, hub_radius, 0.0f);
+        setQuadPosition(quad + 16, wheel_1_position, wheel_radius, -angle);
+        setQuadPosition(quad + 20, wheel_2_position, wheel_radius, -angle);
+        setQuadPosition(quad + 24, wheel_3_position, wheel_radius * bottom_scale, angle / bottom_scale);
+        setQuadPosition(quad + 28, wheel_4_position, wheel_radius * bottom_scale, angle / bottom_scale);
+        quad += 4 * cart_quads;
+
+        // Joints, the cart's then the end of each link
+        setJoint(quad, position);
+        quad += 8;
+        for (auto const& o : agent.system.objects) {
+            setJoint(quad, Vec2{o.getWorldPosition(1)});
+            quad += 8;
+        }
+    }
+
+    static void setJoint(sf::Vertex* quad, Vec2 position)
+    {
+        setQuadPosition(quad, position, joint_radius + joint_outline, 0.0f);
+        setQuadPosition(quad + 4, position, joint_radius, 0.0f);
+    }
+
+    /// Square centered on the position, rotated by angle (radians)
+    static void setQuadPosition(sf::Vertex* quad, Vec2 center, float half_size, float angle)
+    {
+        float const ca = std::cos(angle) * half_size;
+        float const sa = std::sin(angle) * half_size;
+        quad[0].position = center + Vec2{-ca + sa, -sa - ca};
+        quad[1].position = center + Vec2{ ca + sa,  sa - ca};
+        quad[2].position = center + Vec2{ ca - sa,  sa + ca};
+        quad[3].position = center + Vec2{-ca - sa, -sa + ca};
+    }
+
+    static void setQuadStyle(sf::Vertex* quad, sf::FloatRect const& rect, sf::Color quad_color)
+    {
+        quad[0].texCoords = {rect.left, rect.top};
+        quad[1].texCoords = {rect.left + rect.width, rect.top};
+        quad[2].texCoords = {rect.left + rect.width, rect.top + rect.height};
+        quad[3].texCoords = {rect.left, rect.top + rect.height};
+        for (uint32_t k{0}; k < 4; ++k) {
+            quad[k].color = quad_color;
+        }
+    }
+
+    /// Layout: | disc | wheel | white |
+    void createAtlas(sf::Image const& wheel)
+    {
+        sf::Vector2u const wheel_size = wheel.getSize();
+        uint32_t const width  = disc_size + padding + wheel_size.x + padding + 4;
+        uint32_t const height = std::max(disc_size, wheel_size.y);
+
+        sf::Image image;
+        image.create(width, height, sf::Color::Transparent);
+
+        // Anti-aliased disc
+        float const radius = 0.5f * static_cast<float>(disc_size);
+        for (uint32_t y{0}; y < disc_size; ++y) {
+            for (uint32_t x{0}; x < disc_size; ++x) {
+                float const dx = static_cast<float>(x) + 0.5f - radius;
+                float const dy = static_cast<float>(y) + 0.5f - radius;
+                float const coverage = std::clamp(radius - std::sqrt(dx * dx + dy * dy), 0.0f, 1.0f);
+                image.setPixel(x, y, {255, 255, 255, static_cast<uint8_t>(255.0f * coverage)});
+            }
+        }
+        disc_rect = {0.0f, 0.0f, static_cast<float>(disc_size), static_cast<float>(disc_size)};
+
+        uint32_t const wheel_x = disc_size + padding;
+        for (uint32_t y{0}; y < wheel_size.y; ++y) {
+            for (uint32_t x{0}; x < wheel_size.x; ++x) {
+                image.setPixel(wheel_x + x, y, wheel.getPixel(x, y));
+            }
+        }
+        wheel_rect = {static_cast<float>(wheel_x), 0.0f, static_cast<float>(wheel_size.x), static_cast<float>(wheel_size.y)};
+
+        uint32_t const white_x = wheel_x + wheel_size.x + padding;
+        for (uint32_t y{0}; y < 4; ++y) {
+            for (uint32_t x{0}; x < 4; ++x) {
+                image.setPixel(white_x + x, y, sf::Color::White);
+            }
+        }
+        // Texel centers only, to avoid sampling the neighbors
+        white_rect = {static_cast<float>(white_x) + 1.5f, 1.5f, 1.0f, 1.0f};
+
+        atlas.loadFromImage(image);
+        atlas.setSmooth(true);
+    }
+};
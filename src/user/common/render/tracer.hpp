@@ -1,19 +1,39 @@
 #pragma once
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
 #include "engine/engine.hpp"
+#include "engine/common/math.hpp"
+#include "engine/common/smooth/smooth.hpp"
 
 
+/** Trail of points drawn as a triangle strip whose width fades with the age of the points.
+ *  The number of points is bounded, when the buffer is full the older half is decimated by keeping
+ *  one point out of two, so the trail keeps its length with less detail where it is already faded.
+ *  Vertices are only written when a point is added or while its width is still changing.
+ */
 struct Tracer
 {
-    sf::Color                color = sf::Color::White;
-    std::vector<Vec2>        points;
-    std::vector<SmoothFloat> width;
-    sf::VertexArray          va_line;
+    sf::Color          color = sf::Color::White;
+    std::vector<Vec2>  points;
+    /// Creation time of each point
+    std::vector<float> times;
+    /// Unit normal of the segment ending at each point
+    std::vector<Vec2>  normals;
+    std::vector<float> widths;
+    sf::VertexArray    va_line;
 
     float width_start = 4.0f;
     float width_end   = 0.0f;
     float width_speed = 0.0f;
     Interpolation interpolation = Interpolation::EaseInOutQuint;
 
+    /// Maximum number of points, has to be a multiple of 4
+    uint32_t capacity     = 1024;
+    /// Points before this one reached their final width
+    uint32_t first_fading = 0;
+
     explicit
     Tracer()
         : va_line{sf::PrimitiveType::TriangleStrip}
@@ -22,46 +42,130 @@ struct Tracer
     void setColor(sf::Color c)
     {
         color = c;
+        for (uint32_t i{0}; i < va_line.getVertexCount(); ++i) {
+            va_line[i].color = color;
+        }
     }
 
     void clear()
     {
         points.clear();
-        width.clear();
+        times.clear();
+        normals.clear();
+        widths.clear();
+        va_line.clear();
+        first_fading = 0;
     }
 
     void addPoint(Vec2 pt)
     {
+        if (points.size() >= capacity) {
+            decimate();
+        }
         points.push_back(pt);
-        auto& w = width.emplace_back();
-        w.setValueInstant(width_start);
-        w.setInterpolationFunction(interpolation);
-        w.setSpeed(width_speed);
-        w = width_end;
+        times.push_back(pez::core::getTime());
+        normals.push_back(computeNormal(getCount() - 1));
+        widths.push_back(width_start);
+        if (getCount() > 1) {
+            va_line.append({});
+            va_line.append({});
+            writeVertices(getCount() - 1);
+        }
     }
 
     void render(pez::render::Context& context)
     {
-        va_line.resize(2 * points.size() - 2);
-
-        if (points.size() > 1) {
-            Vec2 last = points[0];
-            uint32_t i{0};
-            for (auto const& pt: points) {
-                if (i > 0) {
-                    Vec2 const current = pt;
-                    Vec2 const d = current - last;
-                    Vec2 const n = MathVec2::normalize(MathVec2::normal(d));
-                    float const w = width[i].get();
-                    va_line[2 * (i - 1) + 0].position = current + w * n;
-                    va_line[2 * (i - 1) + 1].position = current - w * n;
-                    va_line[2 * (i - 1) + 0].color = color;
-                    va_line[2 * (i - 1) + 1].color = color;
-                    last = current;
-                }
-                ++i;
+        if (getCount() < 2) {
+            return;
+        }
+        updateWidths();
+        for (uint32_t i{std::max(first_fading, 1u)}; i < getCount(); ++i) {
+            writeVertices(i);
+        }
+        context.draw(va_line);
+    }
+
+    [[nodiscard]]
+    uint32_t getCount() const
+    {
+        return static_cast<uint32_t>(points.size());
+    }
+
+private:
+    /// Widths of the points still fading, points are added in time order so they are all at the end
+    void updateWidths()
+    {
+        uint32_t const count = getCount();
+        if (width_speed == 0.0f) {
+            // Same as SmoothFloat, widths never leave width_start so all points are done
+            first_fading = count;
+            return;
+        }
+        float const now   = pez::core::getTime();
+        for (uint32_t i{first_fading}; i < count; ++i) {
+            float const t = std::min((now - times[i]) * width_speed, 1.0f);
+            float const r = Smooth::getInterpolationValue(t, interpolation);
+            widths[i] = width_start * (1.0f - r) + width_end * r;
+        }
+        // Vertices of the points done fading will not change anymore
+        while (first_fading < count && (now - times[first_fading]) * width_speed >= 1.0f) {
+            ++first_fading;
+        }
+    }
+
+    void writeVertices(uint32_t i)
+    {
+        Vec2 const offset = widths[i] * normals[i];
+        sf::Vertex* const v = &va_line[2 * (i - 1)];
+        v[0].position = points[i] + offset;
+        v[1].position = points[i] - offset;
+        v[0].color    = color;
+        v[1].color    = color;
+    }
+
+    [[nodiscard]]
+    Vec2 computeNormal(uint32_t i) const
+    {
+        if (i == 0) {
+            return {};
+        }
+        Vec2 const d = points[i] - points[i - 1];
+        if (d.x == 0.0f && d.y == 0.0f) {
+            // Keep the previous direction instead of an undefined one
+            return normals[i - 1];
+        }
+        return MathVec2::normalize(MathVec2::normal(d));
+    }
+
+    /// Keeps one point out of two in the older half of the buffer
+    void decimate()
+    {
+        // The older half has to be even to keep exactly half / 2 points, first_fading's update relies on it
+        assert(capacity >= 4 && capacity % 4 == 0);
+        uint32_t const half = getCount() / 2;
+        uint32_t kept = 0;
+        for (uint32_t i{0}; i < getCount(); ++i) {
+            if (i < half && (i & 1)) {
+                continue;
             }
-            context.draw(va_line);
+            points[kept] = points[i];
+            times[kept]  = times[i];
+            widths[kept] = widths[i];
+            ++kept;
+        }
+        first_fading = first_fading < half ? (first_fading + 1) / 2 : first_fading - half / 2;
+        points.resize(kept);
+        times.resize(kept);
+        widths.resize(kept);
+
+        // Segments changed, everything has to be written again
+        normals.resize(kept);
+        for (uint32_t i{0}; i < kept; ++i) {
+            normals[i] = computeNormal(i);
+        }
+        va_line.resize(kept > 1 ? 2 * (kept - 1) : 0);
+        for (uint32_t i{1}; i < kept; ++i) {
+            writeVertices(i);
         }
     }
 };
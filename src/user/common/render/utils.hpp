@@ -10,6 +10,12 @@ namespace common
 struct Utils
 {
     static void generateLine(sf::VertexArray& va, uint32_t index, sf::Vector2f point_1, sf::Vector2f point_2, float width, sf::Color color, float offset = 0.0f)
+    {
+        generateLine(&va[index], point_1, point_2, width, color, offset);
+    }
+
+    /// Writes the quad's 4 vertices
+    static void generateLine(sf::Vertex* va, sf::Vector2f point_1, sf::Vector2f point_2, float width, sf::Color color, float offset = 0.0f)
     {
         sf::Vector2f const p1_p2  = point_2 - point_1;
         float const        length = std::sqrt(p1_p2.x * p1_p2.x + p1_p2.y * p1_p2.y);
@@ -19,15 +25,15 @@ struct Utils
         Vec2 const offset_v = v * (offset * 0.5f);
         Vec2 const normal_v = n * 0.5f * width;
 
-        va[index + 0].position = point_1 + offset_v + normal_v;
-        va[index + 1].position = point_2 - offset_v + normal_v;
-        va[index + 2].position = point_2 - offset_v - normal_v;
-        va[index + 3].position = point_1 + offset_v - normal_v;
+        va[0].position = point_1 + offset_v + normal_v;
+        va[1].position = point_2 - offset_v + normal_v;
+        va[2].position = point_2 - offset_v - normal_v;
+        va[3].position = point_1 + offset_v - normal_v;
 
-        va[index + 0].color = color;
-        va[index + 1].color = color;
-        va[index + 2].color = color;
-        va[index + 3].color = color;
+        va[0].color = color;
+        va[1].color = color;
+        va[2].color = color;
+        va[3].color = color;
     }
 
     static void generateBezier(sf::VertexArray& va, Vec2 pt1, Vec2 pt2, Vec2 pt3, uint32_t pts_count, sf::Color color, float offset = 0.0f)
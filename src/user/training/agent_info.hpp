@@ -34,6 +34,19 @@ struct AgentInfo : public pez::core::Entity
         return nt::NetworkGenerator().generate(genome);
     }
 
+    /// Generates the network actually executed by the simulation, dead parts of the genome are pruned
+    [[nodiscard]]
+    nt::Network compileNetwork(nt::ActivationTier tier = nt::ActivationTier::Exact) const
+    {
+        return nt::NetworkGenerator().compile(genome, tier);
+    }
+
+    /// Brings a network compiled from a previous genome up to date, only rebuilding it if the topology changed
+    nt::NetworkGenerator::UpdateResult updateNetwork(nt::Network& network, nt::ActivationTier tier) const
+    {
+        return nt::NetworkGenerator().update(network, genome, tier);
+    }
+
     void resetGenome()
     {
         genome = nt::Genome{conf::net::input_count, conf::net::output_count};
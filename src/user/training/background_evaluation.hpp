@@ -0,0 +1,168 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "engine/engine.hpp"
+#include "engine/common/stopwatch.hpp"
+
+#include "user/common/configuration.hpp"
+#include "user/training/scene.hpp"
+
+
+namespace training
+{
+
+/** Evaluates the scenes hidden by the demo against the reference disturbance sequence.
+ *  The evaluation is spread over the frames, each frame the scenes are stepped on the thread pool
+ *  until the time budget is spent, so the displayed scenes keep their pace.
+ */
+struct BackgroundEvaluation
+{
+    struct Stats
+    {
+        uint32_t count      = 0;
+        float    best_score = 0.0f;
+        float    mean_score = 0.0f;
+        /// Score reached by the best 10%, 50% and 90% of the evaluated scenes
+        float    score_90   = 0.0f;
+        float    score_50   = 0.0f;
+        float    score_10   = 0.0f;
+        /// Wall clock duration of the evaluation
+        float    duration   = 0.0f;
+        uint64_t agent_steps = 0;
+    };
+
+    /// Steps done by each scene between two budget checks
+    uint32_t steps_per_dispatch = 4;
+
+    bool          running     = false;
+    uint32_t      first_scene = 0;
+    pbd::RealType time        = 0.0;
+    Stopwatch     stopwatch;
+    Stats         stats;
+
+    /// Restarts the scenes from first_scene_ to the last one with the reference disturbances
+    void start(uint32_t first_scene_)
+    {
+        first_scene = first_scene_;
+        time        = 0.0;
+        running     = true;
+        stats       = {};
+        stopwatch.reset();
+        forEachScene([](Scene& s) {
+            s.push_sequence_id   = 0;
+            s.enable_disturbance = true;
+            s.freeze_time        = 0.0;
+            s.initialize();
+        });
+    }
+
+    void stop()
+    {
+        running = false;
+    }
+
+    /// Advances the evaluation during budget_ms at most, returns true when the evaluation just completed
+    bool update(float dt, float budget_ms)
+    {
+        if (!running) {
+            return false;
+        }
+        Stopwatch budget;
+        auto&          tasks       = pez::core::getData<Scene>().getData();
+        uint32_t const tasks_count = getSceneCount();
+        auto&          thread_pool = pez::core::getSingleton<tp::ThreadPool>();
+        while (time < conf::sel::max_iteration_time && budget.getElapsedMs() < budget_ms) {
+            uint32_t const steps = std::min(steps_per_dispatch, static_cast<uint32_t>(std::ceil((conf::sel::max_iteration_time - time) / dt)));
+            std::atomic<uint64_t> agent_steps{0};
+            thread_pool.dispatch(tasks_count, [&](uint32_t start, uint32_t end) {
+                uint64_t local_steps = 0;
+                for (uint32_t i{start}; i < end; ++i) {
+                    Scene& scene = tasks[first_scene + i];
+                    for (uint32_t k{steps}; k--;) {
+                        scene.update(dt);
+                    }
+                    local_steps += steps * scene.configuration.task_sub_steps;
+                }
+                agent_steps += local_steps;
+            });
+            stats.agent_steps += agent_steps;
+            time += steps * dt;
+        }
+
+        if (time < conf::sel::max_iteration_time) {
+            return false;
+        }
+        running = false;
+        computeStats();
+        return true;
+    }
+
+    void printStats() const
+    {
+        std::cout << "[Evaluation] " << stats.count << " agents in " << toString(stats.duration, 1) << " s"
+                  << " (" << toString(to<float>(stats.agent_steps) / std::max(stats.duration, 1e-3f) * 1e-6f, 1) << "M steps/s)" << std::endl;
+        std::cout << "[Evaluation] Best: " << stats.best_score << " Mean: " << stats.mean_score
+                  << " Top 10%: " << stats.score_90 << " Median: " << stats.score_50 << " Top 90%: " << stats.score_10 << std::endl;
+    }
+
+    [[nodiscard]]
+    uint32_t getSceneCount() const
+    {
+        uint32_t const count = pez::core::getCount<Scene>();
+        return count > first_scene ? count - first_scene : 0;
+    }
+
+    /// Simulated time reached by the evaluated scenes, in [0, 1]
+    [[nodiscard]]
+    float getProgress() const
+    {
+        return to<float>(time) / conf::sel::max_iteration_time;
+    }
+
+private:
+    template<typename TCallback>
+    void forEachScene(TCallback&& callback)
+    {
+        auto& tasks = pez::core::getData<Scene>().getData();
+        uint32_t const tasks_count = getSceneCount();
+        pez::core::getSingleton<tp::ThreadPool>().dispatch(tasks_count, [&](uint32_t start, uint32_t end) {
+            for (uint32_t i{start}; i < end; ++i) {
+                callback(tasks[first_scene + i]);
+            }
+        });
+    }
+
+    void computeStats()
+    {
+        std::vector<float> scores;
+        auto& tasks = pez::core::getData<Scene>().getData();
+        for (uint32_t i{first_scene}; i < first_scene + getSceneCount(); ++i) {
+            scores.push_back(to<float>(tasks[i].getAgentInfo().score));
+        }
+        stats.count    = to<uint32_t>(scores.size());
+        stats.duration = stopwatch.getElapsedSeconds();
+        if (scores.empty()) {
+            return;
+        }
+        std::sort(scores.begin(), scores.end(), std::greater<>());
+        auto const getPercentile = [&](float ratio) {
+            return scores[to<uint32_t>(ratio * to<float>(scores.size() - 1))];
+        };
+        double score_sum = 0.0;
+        for (float const s : scores) {
+            score_sum += s;
+        }
+        stats.best_score = scores.front();
+        stats.mean_score = to<float>(score_sum / to<double>(scores.size()));
+        stats.score_90   = getPercentile(0.1f);
+        stats.score_50   = getPercentile(0.5f);
+        stats.score_10   = getPercentile(0.9f);
+    }
+};
+
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "engine/engine.hpp"
+#include "engine/common/binary_io.hpp"
+#include "engine/common/number_generator.hpp"
+
+#include "user/common/disturbances.hpp"
+#include "user/training/agent_info.hpp"
+#include "user/training/training_state.hpp"
+
+
+namespace training
+{
+
+/** Snapshot of the whole population and training context, stored in a single file
+ *
+ *  Layout: Header | payload
+ *  The payload holds the training state, the RNG state, the disturbance sequences
+ *  and the score and genome of every agent. The header stores its size and checksum.
+ */
+struct Checkpoint
+{
+    static constexpr uint32_t magic   = 0x4B435450; // "PTCK"
+    static constexpr uint32_t version = 2;
+
+    struct Header
+    {
+        uint32_t magic        = 0;
+        uint32_t version      = 0;
+        uint64_t payload_size = 0;
+        uint64_t checksum     = 0;
+    };
+
+    /// Serializes the current population, this is the only part that needs to run on the training thread
+    [[nodiscard]]
+    static std::vector<char> create()
+    {
+        BinaryBufferWriter payload;
+        writeState(payload, pez::core::getSingleton<TrainingState>());
+        payload.writeString(RNGf::getState());
+
+        payload.write(pez::core::getCount<Disturbances>());
+        pez::core::foreach<Disturbances>([&](Disturbances const& d) {
+            payload.write(static_cast<uint64_t>(d.pushes.size()));
+            for (auto const& p : d.pushes) {
+                payload.write(p);
+            }
+        });
+
+        payload.write(pez::core::getCount<AgentInfo>());
+        pez::core::foreach<AgentInfo>([&](AgentInfo const& a) {
+            payload.write(a.score);
+            a.genome.encode(payload.buffer);
+        });
+
+        Header const header{magic, version, payload.getSize(), computeChecksum(payload.buffer.data(), payload.getSize())};
+        BinaryBufferWriter result;
+        result.buffer.reserve(sizeof(Header) + payload.getSize());
+        result.write(header);
+        result.writeBytes(payload.buffer.data(), payload.getSize());
+        return std::move(result.buffer);
+    }
+
+    /// Restores the population stored in the file, returns false if the file is missing, corrupted or incompatible
+    static bool load(std::string const& filename)
+    {
+        std::ifstream infile{filename, std::ios::binary};
+        if (!infile) {
+            std::cout << "Cannot open file \"" << filename << "\"" << std::endl;
+            return false;
+        }
+        std::vector<char> const data{std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>()};
+
+        BinaryBufferReader reader{data.data(), data.size()};
+        auto const header = reader.read<Header>();
+        if (!reader.isValid() || header.magic != magic) {
+            std::cout << "\"" << filename << "\" is not a checkpoint" << std::endl;
+            return false;
+        }
+        if (header.version != version) {
+            std::cout << "\"" << filename << "\" has unsupported version " << header.version << std::endl;
+            return false;
+        }
+        if (header.payload_size != data.size() - reader.cursor ||
+            header.checksum != computeChecksum(data.data() + reader.cursor, header.payload_size)) {
+            std::cout << "\"" << filename << "\" is corrupted" << std::endl;
+            return false;
+        }
+
+        // Validate the population size before touching anything
+        TrainingState loaded_state;
+        readState(reader, loaded_state);
+        std::string const rng_state = reader.readString();
+
+        auto const disturbances_count = reader.read<uint32_t>();
+        if (disturbances_count != pez::core::getCount<Disturbances>()) {
+            std::cout << "Checkpoint disturbances count mismatch" << std::endl;
+            return false;
+        }
+        std::vector<std::vector<Disturbances::Push>> pushes(disturbances_count);
+        for (auto& sequence : pushes) {
+            sequence.resize(reader.read<uint64_t>());
+            for (auto& p : sequence) {
+                reader.readInto(p);
+            }
+        }
+
+        auto const agents_count = reader.read<uint32_t>();
+        if (agents_count != pez::core::getCount<AgentInfo>()) {
+            std::cout << "Checkpoint population size mismatch" << std::endl;
+            return false;
+        }
+        std::vector<AgentInfo> agents(agents_count);
+        for (auto& a : agents) {
+            reader.readInto(a.score);
+            a.genome.decode(reader);
+        }
+
+        if (!reader.isValid()) {
+            std::cout << "\"" << filename << "\" is truncated" << std::endl;
+            return false;
+        }
+
+        // Everything is valid, apply
+        auto& state = pez::core::getSingleton<TrainingState>();
+        state.iteration             = loaded_state.iteration;
+        state.iteration_exploration = loaded_state.iteration_exploration;
+        state.iteration_best_score  = loaded_state.iteration_best_score;
+        state.configuration         = loaded_state.configuration;
+        RNGf::setState(rng_state);
+        {
+            uint32_t i{0};
+            pez::core::foreach<Disturbances>([&](Disturbances& d) {
+                d.pushes = std::move(pushes[i++]);
+            });
+        }
+        {
+            uint32_t i{0};
+            pez::core::foreach<AgentInfo>([&](AgentInfo& a) {
+                a.score  = agents[i].score;
+                a.genome = std::move(agents[i].genome);
+                ++i;
+            });
+        }
+
+        std::cout << "\"" << filename << "\" loaded, resuming at iteration " << state.iteration << std::endl;
+        return true;
+    }
+
+private:
+    template<typename TWriter>
+    static void writeState(TWriter& writer, TrainingState const& state)
+    {
+        writer.write(state.iteration);
+        writer.write(state.iteration_exploration);
+        writer.write(state.iteration_best_score);
+        state.configuration.write(writer);
+    }
+
+    template<typename TReader>
+    static void readState(TReader& reader, TrainingState& state)
+    {
+        reader.readInto(state.iteration);
+        reader.readInto(state.iteration_exploration);
+        reader.readInto(state.iteration_best_score);
+        state.configuration.read(reader);
+    }
+};
+
+}
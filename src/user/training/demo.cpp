@@ -7,13 +7,11 @@ void training::Demo::initialize()
     enable_disturbance = false;
     initialized        = true;
 
+    evaluation.stop();
+
     // Initialize tasks
     pez::core::parallelForeach<training::Scene>([&](training::Scene& s) {
-        // Use reference push sequence
-        s.push_sequence_id   = 0;
-        s.enable_disturbance = enable_disturbance;
-        s.initialize();
-        s.freeze_time = 1.0f;
+        initializeScene(s);
     });
 
     auto& renderer = pez::core::getRenderer<Renderer>();
@@ -25,3 +23,30 @@ void training::Demo::initialize()
     renderer.demo_renderer.tracer_tip.clear();
     renderer.demo_renderer.tracer_mid.clear();
 }
+
+void training::Demo::initializeScene(Scene& s) const
+{
+    // Use reference push sequence
+    s.push_sequence_id   = 0;
+    s.enable_disturbance = enable_disturbance;
+    // Scenes are shared with the training, which can use an approximate tier
+    s.activation_tier    = nt::ActivationTier::Exact;
+    // Only the best agent's network is rendered, its connections values are recorded by the gather path
+    s.record_connection_values = (s.agent_id == 0);
+    if (s.agent_id == 0) {
+        s.execution_mode = nt::ExecutionMode::Gather;
+    }
+    s.initialize();
+    s.freeze_time = 1.0f;
+}
+
+uint32_t training::Demo::getDisplayedSceneCount()
+{
+    auto const& demo_renderer = pez::core::getRenderer<Renderer>().demo_renderer;
+    return demo_renderer.best_only ? 1 : demo_renderer.scene_count;
+}
+
+void training::Demo::setDisplayedSceneCount(uint32_t count)
+{
+    pez::core::getRenderer<Renderer>().demo_renderer.scene_count = count;
+}
@@ -1,7 +1,12 @@
 #pragma once
+#include <memory>
+
 #include "engine/engine.hpp"
+#include "engine/common/async_writer.hpp"
 #include "user/training/training_state.hpp"
 #include "user/training/scene.hpp"
+#include "user/training/replay.hpp"
+#include "user/training/background_evaluation.hpp"
 
 
 namespace training
@@ -17,6 +22,16 @@ struct Demo : public pez::core::IProcessor
     bool          enable_disturbance = false;
     pbd::RealType max_friction       = 0.0;
 
+    // Replays
+    AsyncWriter                   async_writer;
+    std::unique_ptr<ReplayWriter> replay_writer;
+    std::unique_ptr<ReplayReader> replay_reader;
+    std::string                   replay_filename;
+    /// Next frame shown during a playback
+    uint32_t                      replay_frame = 0;
+
+    BackgroundEvaluation evaluation;
+
     Demo()
         : state{pez::core::getSingleton<TrainingState>()}
         , thread_pool{pez::core::getSingleton<tp::ThreadPool>()}
@@ -36,9 +51,32 @@ struct Demo : public pez::core::IProcessor
             initialize();
         }
 
-        updateAgents(dt);
+        if (replay_reader) {
+            updatePlayback();
+            return;
+        }
+
+        uint32_t const simulated_count = getSimulatedCount();
+        updateAgents(dt, simulated_count);
+        if (replay_writer) {
+            replay_writer->addFrame([](uint32_t i) -> Scene const& {
+                return pez::core::get<Scene>(i);
+            });
+        }
+        updateEvaluation(dt, simulated_count);
+    }
+
+    /// Scenes that are displayed or recorded, the others are not simulated
+    [[nodiscard]]
+    uint32_t getSimulatedCount() const
+    {
+        uint32_t const recorded_count = replay_writer ? conf::exp::replay_scene_count : 0;
+        return std::min(std::max(getDisplayedSceneCount(), recorded_count), pez::core::getCount<Scene>());
     }
 
+    [[nodiscard]]
+    static uint32_t getDisplayedSceneCount();
+
     static Scene& getBest()
     {
         return pez::core::get<Scene>(0);
@@ -53,9 +91,11 @@ struct Demo : public pez::core::IProcessor
     void toggleDisturbances()
     {
         enable_disturbance = !enable_disturbance;
-        pez::core::foreach<training::Scene>([&](training::Scene& s) {
-            s.enable_disturbance = enable_disturbance;
-        });
+        // Scenes being evaluated keep the reference disturbances
+        uint32_t const count = evaluation.running ? evaluation.first_scene : pez::core::getCount<Scene>();
+        for (uint32_t i{0}; i < count; ++i) {
+            pez::core::get<Scene>(i).enable_disturbance = enable_disturbance;
+        }
     }
 
     void toggle()
@@ -65,6 +105,9 @@ struct Demo : public pez::core::IProcessor
 
     void endDemo()
     {
+        evaluation.stop();
+        stopRecording();
+        stopPlayback();
         initialized = false;
         auto& best = getBest();
         state.endDemo();
@@ -78,6 +121,147 @@ struct Demo : public pez::core::IProcessor
         });
     }
 
+    /// Records the first scenes of the demo, the recording stops with the demo
+    void toggleRecording()
+    {
+        if (replay_writer) {
+            stopRecording();
+            return;
+        }
+        if (!state.demo || replay_reader) {
+            std::cout << "[WARNING] Replays can only be recorded while the demo runs" << std::endl;
+            return;
+        }
+        uint32_t const scene_count = std::min(conf::exp::replay_scene_count, pez::core::getCount<Scene>());
+        replay_filename = "replay_" + toString(state.iteration) + ".bin";
+        replay_writer   = std::make_unique<ReplayWriter>(async_writer, replay_filename, scene_count, conf::exp::replay_block_frames);
+        std::cout << "Recording " << replay_filename << std::endl;
+    }
+
+    void stopRecording()
+    {
+        if (!replay_writer) {
+            return;
+        }
+        std::cout << "Recorded " << replay_writer->getFrameCount() << " frames" << std::endl;
+        replay_writer.reset();
+    }
+
+    /// Plays the last recorded replay in the demo, the scenes are not simulated
+    void togglePlayback()
+    {
+        if (replay_reader) {
+            stopPlayback();
+            // Back to a simulated demo
+            initialize();
+            return;
+        }
+        if (replay_filename.empty()) {
+            std::cout << "[WARNING] No replay recorded" << std::endl;
+            return;
+        }
+        stopEvaluation();
+        stopRecording();
+        async_writer.flush();
+        auto reader = std::make_unique<ReplayReader>(replay_filename);
+        if (!reader->isValid()) {
+            std::cout << "[WARNING] Cannot read " << replay_filename << std::endl;
+            return;
+        }
+        if (!state.demo) {
+            setActive(true);
+        }
+        replay_reader = std::move(reader);
+        replay_frame  = 0;
+        setDisplayedSceneCount(replay_reader->getSceneCount());
+    }
+
+    void stopPlayback()
+    {
+        if (replay_reader) {
+            replay_reader.reset();
+            setDisplayedSceneCount(pez::core::getCount<Scene>());
+        }
+    }
+
+    /// Moves the playback by a number of frames
+    void seekPlayback(int32_t offset)
+    {
+        if (replay_reader) {
+            int64_t const last = static_cast<int64_t>(replay_reader->getFrameCount()) - 1;
+            replay_frame = static_cast<uint32_t>(std::clamp(static_cast<int64_t>(replay_frame) + offset, int64_t{0}, last));
+        }
+    }
+
+    void updatePlayback()
+    {
+        replay_reader->seek(replay_frame);
+        for (uint32_t i{0}; i < replay_reader->getSceneCount(); ++i) {
+            Replay::apply(replay_reader->getValues(i), pez::core::get<Scene>(i));
+        }
+        // The last frame stays on screen
+        if (replay_frame + 1 < replay_reader->getFrameCount()) {
+            ++replay_frame;
+        }
+    }
+
+    static void setDisplayedSceneCount(uint32_t count);
+
+    /// Evaluates the hidden population at full speed while the best agent is displayed
+    void toggleEvaluation()
+    {
+        if (evaluation.running) {
+            stopEvaluation();
+            return;
+        }
+        if (!state.demo || replay_reader || getSimulatedCount() > 1) {
+            std::cout << "[WARNING] The population can only be evaluated while only the best agent is simulated" << std::endl;
+            return;
+        }
+        evaluation.start(1);
+        std::cout << "[Evaluation] Started on " << evaluation.getSceneCount() << " agents" << std::endl;
+    }
+
+    /// Restores the evaluated scenes, they catch up with the best one when they are displayed
+    void stopEvaluation()
+    {
+        if (!evaluation.running) {
+            return;
+        }
+        evaluation.stop();
+        restoreHiddenScenes();
+    }
+
+    void updateEvaluation(float dt, uint32_t simulated_count)
+    {
+        if (!evaluation.running) {
+            return;
+        }
+        // Scenes that became visible cannot be evaluated anymore
+        if (simulated_count > evaluation.first_scene) {
+            std::cout << "[Evaluation] Canceled" << std::endl;
+            stopEvaluation();
+            return;
+        }
+        if (evaluation.update(dt, conf::exp::evaluation_budget_ms)) {
+            evaluation.printStats();
+            restoreHiddenScenes();
+        }
+    }
+
+    void restoreHiddenScenes()
+    {
+        auto& tasks = pez::core::getData<Scene>().getData();
+        uint32_t const first = evaluation.first_scene;
+        thread_pool.dispatch(pez::core::getCount<Scene>() - first, [&](uint32_t start, uint32_t end) {
+            for (uint32_t i{start}; i < end; ++i) {
+                initializeScene(tasks[first + i]);
+            }
+        });
+    }
+
+    void initializeScene(Scene& s) const;
+
     void setActive(bool b)
     {
         state.demo = b;
@@ -88,15 +272,26 @@ struct Demo : public pez::core::IProcessor
         }
     }
 
-    void updateAgents(float dt)
+    /** Steps the first scenes, the other ones are paused.
+     *  Scenes left behind while hidden catch up with the best one, a few steps per frame.
+     */
+    void updateAgents(float dt, uint32_t count)
     {
-        uint32_t const tasks_count = pez::core::getCount<training::Scene>();
-        auto&          tasks       = pez::core::getData<training::Scene>().getData();
+        auto& tasks = pez::core::getData<training::Scene>().getData();
+        if (!count) {
+            return;
+        }
 
-        thread_pool.dispatch(tasks_count, [&](uint32_t start, uint32_t end) {
+        pbd::RealType const target_time = tasks[0].current_time + dt;
+        thread_pool.dispatch(count, [&](uint32_t start, uint32_t end) {
             for (uint32_t i{start}; i < end; ++i) {
-                if (!tasks[i].done()) {
+                uint32_t steps = 0;
+                while (!tasks[i].done() && steps < conf::exp::demo_catch_up_steps) {
                     tasks[i].update(dt);
+                    ++steps;
+                    if (tasks[i].current_time + 0.5 * dt >= target_time) {
+                        break;
+                    }
                 }
             }
         });
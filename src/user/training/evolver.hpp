@@ -10,6 +10,20 @@ struct Evolver
 {
     using AgentInfoVector = std::vector<AgentInfo>;
 
+    /// Statistics of the last evaluated generation
+    struct Stats
+    {
+        float    best_score       = 0.0f;
+        float    mean_score       = 0.0f;
+        /// Score reached by the best 10%, 50% and 90% of the population
+        float    score_90         = 0.0f;
+        float    score_50         = 0.0f;
+        float    score_10         = 0.0f;
+        float    connections_mean = 0.0f;
+        uint32_t connections_max  = 0;
+        float    nodes_mean       = 0.0f;
+    };
+
     TrainingState& state;
 
     Selector selector;
@@ -17,6 +31,8 @@ struct Evolver
     AgentInfoVector old_generation;
     AgentInfoVector new_generation;
 
+    Stats stats;
+
     Evolver()
         : state{pez::core::getSingleton<TrainingState>()}
     {
@@ -35,6 +51,7 @@ struct Evolver
         });
 
         state.iteration_best_score = old_generation[0].score;
+        computeStats();
         std::cout << "[" << state.iteration << "] Iteration best: " << state.iteration_best_score << std::endl;
 
         // Keep elite
@@ -64,6 +81,35 @@ struct Evolver
         updatePopulation();
     }
 
+    /// Computes the statistics of the old generation, it has to be sorted by decreasing score
+    void computeStats()
+    {
+        auto const count = to<uint32_t>(old_generation.size());
+        auto const getPercentile = [&](float ratio) {
+            return to<float>(old_generation[to<uint32_t>(ratio * to<float>(count - 1))].score);
+        };
+
+        double   score_sum       = 0.0;
+        uint64_t connections_sum = 0;
+        uint64_t nodes_sum       = 0;
+        stats.connections_max = 0;
+        for (auto const& a : old_generation) {
+            auto const connections = to<uint32_t>(a.genome.connections.size());
+            score_sum       += a.score;
+            connections_sum += connections;
+            nodes_sum       += a.genome.nodes.size();
+            stats.connections_max = std::max(stats.connections_max, connections);
+        }
+
+        stats.best_score       = to<float>(old_generation[0].score);
+        stats.mean_score       = to<float>(score_sum / count);
+        stats.score_90         = getPercentile(0.1f);
+        stats.score_50         = getPercentile(0.5f);
+        stats.score_10         = getPercentile(0.9f);
+        stats.connections_mean = to<float>(connections_sum) / to<float>(count);
+        stats.nodes_mean       = to<float>(nodes_sum) / to<float>(count);
+    }
+
     void fetchOldPopulation()
     {
         uint32_t i{0};
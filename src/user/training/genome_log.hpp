@@ -0,0 +1,124 @@
+#pragma once
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "engine/common/binary_io.hpp"
+#include "engine/common/utils.hpp"
+
+#include "user/common/configuration.hpp"
+
+
+/** Append-only log of the best genomes of an exploration, replacing one file per saved genome.
+ *  The log is split in segments named "best_log_<segment>.bin" to keep files at a reasonable size.
+ *  Each record is a RecordHeader followed by its payload.
+ */
+struct GenomeLog
+{
+    static constexpr uint32_t record_magic = 0x52474F4C; // "LOGR"
+
+    struct RecordHeader
+    {
+        uint32_t magic     = 0;
+        uint32_t iteration = 0;
+        uint64_t size      = 0;
+        uint64_t checksum  = 0;
+    };
+
+    std::string folder;
+    uint32_t    segment      = 0;
+    uint64_t    segment_size = 0;
+
+    /** Points the log to the folder, new records are appended after the existing ones
+     *
+     * @param folder_ The exploration folder
+     * @param truncate If true, the segments already in the folder are removed (exploration restarted from scratch)
+     */
+    void reset(std::string const& folder_, bool truncate)
+    {
+        folder       = folder_;
+        segment      = 0;
+        segment_size = 0;
+        if (truncate) {
+            std::error_code error;
+            for (uint32_t i{0}; std::filesystem::exists(getSegmentFilename(folder, i)); ++i) {
+                std::filesystem::remove(getSegmentFilename(folder, i), error);
+                if (error) {
+                    std::cout << "[WARNING] Cannot remove \"" << getSegmentFilename(folder, i) << "\": " << error.message() << std::endl;
+                }
+            }
+            return;
+        }
+        // Resume at the last segment
+        while (std::filesystem::exists(getSegmentFilename(folder, segment + 1))) {
+            ++segment;
+        }
+        std::error_code error;
+        auto const size = std::filesystem::file_size(getSegmentFilename(folder, segment), error);
+        segment_size = error ? 0 : size;
+    }
+
+    /** Creates the record to append to the log
+     *
+     * @param iteration The iteration the payload belongs to
+     * @param payload The data to store
+     * @param record The resulting record
+     * @return The segment file the record has to be appended to
+     */
+    std::string createRecord(uint32_t iteration, std::vector<char> const& payload, std::vector<char>& record)
+    {
+        if (segment_size > 0 && segment_size + payload.size() > conf::exp::genome_log_segment_size) {
+            ++segment;
+            segment_size = 0;
+        }
+
+        RecordHeader const header{record_magic, iteration, payload.size(), computeChecksum(payload.data(), payload.size())};
+        BinaryBufferWriter writer;
+        writer.buffer.reserve(sizeof(RecordHeader) + payload.size());
+        writer.write(header);
+        writer.writeBytes(payload.data(), payload.size());
+        record = std::move(writer.buffer);
+
+        segment_size += record.size();
+        return getSegmentFilename(folder, segment);
+    }
+
+    [[nodiscard]]
+    static std::string getSegmentFilename(std::string const& folder, uint32_t segment)
+    {
+        return folder + "/best_log_" + toString(segment) + ".bin";
+    }
+
+    /// Searches the last valid record of the iteration in all the segments of the folder
+    static bool find(std::string const& folder, uint32_t iteration, std::vector<char>& payload)
+    {
+        bool found = false;
+        for (uint32_t segment{0}; std::filesystem::exists(getSegmentFilename(folder, segment)); ++segment) {
+            std::ifstream infile{getSegmentFilename(folder, segment), std::ios::binary | std::ios::ate};
+            auto const file_size = static_cast<uint64_t>(infile.tellg());
+            infile.seekg(0);
+            RecordHeader header;
+            while (infile.read(reinterpret_cast<char*>(&header), sizeof(RecordHeader))) {
+                // The size is read from the file, never trust it before allocating
+                auto const remaining = file_size - static_cast<uint64_t>(infile.tellg());
+                if (header.magic != record_magic || header.size > remaining) {
+                    std::cout << "[WARNING] Corrupted record in segment " << segment << std::endl;
+                    break;
+                }
+                if (header.iteration == iteration) {
+                    std::vector<char> data(header.size);
+                    infile.read(data.data(), static_cast<std::streamsize>(header.size));
+                    if (infile && computeChecksum(data.data(), data.size()) == header.checksum) {
+                        payload = std::move(data);
+                        found   = true;
+                    }
+                } else {
+                    infile.seekg(static_cast<std::streamoff>(header.size), std::ios::cur);
+                }
+            }
+        }
+        return found;
+    }
+};
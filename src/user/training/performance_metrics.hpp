@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "engine/common/stopwatch.hpp"
+#include "engine/common/thread_pool/thread_pool.hpp"
+
+
+/// Throughput measurements of the last training generation
+struct PerformanceMetrics
+{
+    float    generations_per_second = 0.0f;
+    float    agent_steps_per_second = 0.0f;
+    float    simulation_ms          = 0.0f;
+    float    evolve_ms              = 0.0f;
+    uint64_t agent_steps            = 0;
+    /// Percentage of the simulation phase each worker spent executing tasks, the last one is the dispatching thread
+    std::vector<float> workers_busy;
+    /// Work done by the workers and the dispatching thread, as a percentage of the workers' capacity
+    float              pool_busy = 0.0f;
+
+    Stopwatch generation_stopwatch;
+    Stopwatch phase_stopwatch;
+    bool      first_generation = true;
+
+    void startGeneration()
+    {
+        float const generation_time = generation_stopwatch.getElapsedSeconds();
+        generations_per_second = (first_generation || generation_time == 0.0f) ? 0.0f : 1.0f / generation_time;
+        first_generation = false;
+        generation_stopwatch.reset();
+    }
+
+    void startSimulation(tp::ThreadPool& thread_pool)
+    {
+        thread_pool.resetBusyTime();
+        agent_steps = 0;
+        phase_stopwatch.reset();
+    }
+
+    void endSimulation(tp::ThreadPool const& thread_pool, uint64_t steps)
+    {
+        uint64_t const simulation_ns = phase_stopwatch.getElapsedNs();
+        simulation_ms          = static_cast<float>(simulation_ns) * 1.0e-6f;
+        agent_steps            = steps;
+        agent_steps_per_second = simulation_ns ? static_cast<float>(static_cast<double>(steps) * 1.0e9 / static_cast<double>(simulation_ns)) : 0.0f;
+
+        auto const getBusyPercentage = [simulation_ns](uint64_t busy_ns) {
+            return simulation_ns ? 100.0f * static_cast<float>(busy_ns) / static_cast<float>(simulation_ns) : 0.0f;
+        };
+        workers_busy.resize(thread_pool.m_thread_count + 1);
+        for (uint32_t i{0}; i < thread_pool.m_thread_count; ++i) {
+            workers_busy[i] = getBusyPercentage(thread_pool.getBusyTimeNs(i));
+        }
+        workers_busy.back() = getBusyPercentage(thread_pool.getCallerBusyTimeNs());
+
+        float sum = 0.0f;
+        for (float const busy : workers_busy) {
+            sum += busy;
+        }
+        pool_busy = thread_pool.m_thread_count ? sum / static_cast<float>(thread_pool.m_thread_count) : 0.0f;
+    }
+
+    void startEvolve()
+    {
+        phase_stopwatch.reset();
+    }
+
+    void endEvolve()
+    {
+        evolve_ms = phase_stopwatch.getElapsedMs();
+    }
+};
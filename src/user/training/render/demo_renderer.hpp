@@ -6,6 +6,7 @@
 #include "user/common/render/empty_card.hpp"
 #include "user/common/render/graph_widget.hpp"
 #include "user/common/render/network_renderer.hpp"
+#include "user/common/render/population_renderer.hpp"
 #include "user/common/render/multi_graph_widget.hpp"
 #include "user/common/render/tracer.hpp"
 #include "user/common/disturbances.hpp"
@@ -36,8 +37,12 @@ struct DemoRenderer
     Card background;
     Card background_outline;
     AgentRenderer agent_renderer;
+    PopulationRenderer population_renderer;
     EmptyCard slider;
     bool best_only = true;
+    /// Number of scenes shown, lower than the population during a replay
+    uint32_t scene_count = conf::sel::population_size;
+    pez::render::Layer decor_layer;
 
     // HUD
     // --- Graphs ---
@@ -82,6 +87,7 @@ struct DemoRenderer
 
         // Agent
         agent_renderer.cart.offset.y = slider.thickness + slider.corner_radius;
+        population_renderer.initialize(agent_renderer);
 
         // Network renderer
         network_renderer.setFont(font);
@@ -95,7 +101,7 @@ struct DemoRenderer
             output_plot.setTitle("Output (velocity)");
         }
         output_plot.setSize({2.25f * graph_height, graph_height});
-        output_plot.chart.extremes = {0.0f, 0.0f};
+        output_plot.chart.base_extremes = {0.0f, 0.0f};
         output_plot.setColor({233, 196, 106});
         output_plot.chart.values.setMaxValuesCount(200);
         output_plot.height_round = 0.1f;
@@ -158,22 +164,69 @@ struct DemoRenderer
         arrow_texture.loadFromFile("res/arrow.png");
     }
 
+    /** Updates the geometry of the agents and the widgets, each task only writes its own widget's buffers.
+     *  Texts are laid out and drawn in render, fonts and textures are only used from the main thread.
+     */
+    void prepare()
+    {
+        auto const& scene_best = pez::core::get<Scene>(0);
+        auto& thread_pool = pez::core::getSingleton<tp::ThreadPool>();
+
+        // Already spread on the thread pool
+        if (!best_only && scene_count > 1) {
+            population_renderer.update(scene_count - 1, [](uint32_t i) -> Agent const& {
+                return pez::core::get<Scene>(i + 1).agent;
+            });
+        }
+
+        auto const& system  = scene_best.agent.system;
+        auto const  output  = to<float>(scene_best.network.output[0] * scene_best.configuration.max_accel * 0.01);
+        auto const  angle_1 = to<float>(270.0 - Math::radToDeg(system.objects[0].angle));
+        auto const  angle_2 = to<float>(Math::radToDeg(system.objects[0].angle) - Math::radToDeg(system.objects[1].angle));
+
+        thread_pool.addTask([&] {
+            agent_renderer.prepareAgent(scene_best.agent, AgentRenderer::Mode::Solid);
+        });
+        thread_pool.addTask([&] {
+            network_renderer.update();
+        });
+        thread_pool.addTask([&] {
+            output_plot.addValue(output);
+            output_plot.prepare();
+        });
+        thread_pool.addTask([&] {
+            visu_angle_1.addValue(angle_1);
+            visu_angle_1.prepare();
+        });
+        thread_pool.addTask([&] {
+            visu_angle_2.addValue(angle_2);
+            visu_angle_2.prepare();
+        });
+        thread_pool.addTask([&] {
+            visu_angle_vs.addPoint({angle_1, angle_2});
+            visu_angle_vs.prepare();
+        });
+        thread_pool.waitForCompletion();
+    }
+
+    /// Issues the draw calls, the geometry has been built by prepare
     void render(pez::render::Context& context)
     {
         auto const& scene_best = pez::core::get<Scene>(0);
 
-        background_outline.render(context);
-        background.render(context);
+        // The world's decor never changes, it is only rendered when the viewport changes
+        context.drawLayer(decor_layer, [&] {
+            background_outline.render(context);
+            background.render(context);
 
-        slider.render(context);
-        drawHorizontalTicks(context);
+            slider.render(context);
+            drawHorizontalTicks(context);
+        });
 
         // Agents
         // --- Draw other ---
-        uint32_t const agent_count  = best_only ? 1 : conf::sel::population_size;
-        for (uint32_t i{1}; i < agent_count; ++i) {
-            auto const& scene = pez::core::get<Scene>(i);
-            agent_renderer.renderAgent(context, scene.agent, AgentRenderer::Mode::Ghost);
+        if (!best_only && scene_count > 1) {
+            population_renderer.render(context);
         }
         // --- Draw best ---
         agent_renderer.renderAgent(context, scene_best.agent, AgentRenderer::Mode::Solid);
@@ -194,23 +247,12 @@ struct DemoRenderer
         }
 
         // Neural network
-        network_renderer.update();
         network_renderer.render(context);
 
         // Graphs
-        output_plot.addValue(to<float>(scene_best.network.output[0] * scene_best.configuration.max_accel * 0.01));
         output_plot.render(context);
-
-        auto const& system = scene_best.agent.system;
-        auto const angle_1 = to<float>(270.0 - Math::radToDeg(system.objects[0].angle));
-        visu_angle_1.addValue(angle_1);
         visu_angle_1.render(context);
-
-        auto const angle_2 = to<float>(Math::radToDeg(system.objects[0].angle) - Math::radToDeg(system.objects[1].angle));
-        visu_angle_2.addValue(angle_2);
         visu_angle_2.render(context);
-
-        visu_angle_vs.addPoint({angle_1, angle_2});
         visu_angle_vs.render(context);
 
         iteration_state.render(context);
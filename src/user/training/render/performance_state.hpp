@@ -0,0 +1,138 @@
+#pragma once
+#include "engine/engine.hpp"
+#include "engine/window/frame_scheduler.hpp"
+
+#include "user/common/render/graph_widget.hpp"
+#include "user/common/render/bar_graph_widget.hpp"
+#include "user/training/performance_metrics.hpp"
+
+
+/// Training throughput and frame time plots, stacked vertically
+struct PerformanceState
+{
+    float const card_margin = 20.0f;
+
+    Vec2 graph_size;
+    Vec2 position;
+
+    GraphWidget    generations;
+    GraphWidget    agent_steps;
+    GraphWidget    evolve_time;
+    BarGraphWidget workers;
+    GraphWidget    frame_time;
+
+    explicit
+    PerformanceState(Vec2 graph_size_)
+        : graph_size{graph_size_}
+        , generations{graph_size}
+        , agent_steps{graph_size}
+        , evolve_time{graph_size}
+        , workers{graph_size}
+        , frame_time{graph_size}
+    {
+        float const small_font_scale = 0.8f;
+
+        generations.setTitle("Generations/s");
+        generations.setColor({42, 157, 143});
+        generations.chart.base_extremes = {0.0f, 0.0f};
+        generations.chart.values.setMaxValuesCount(200);
+        generations.height_round = 0.1f;
+        generations.font_scale = small_font_scale;
+        generations.current_value_callback = [](float x) {
+            return toString(x, 3);
+        };
+
+        agent_steps.setTitle("Agent steps/s (M)");
+        agent_steps.setColor({233, 196, 106});
+        agent_steps.chart.base_extremes = {0.0f, 0.0f};
+        agent_steps.chart.values.setMaxValuesCount(200);
+        agent_steps.height_round = 1.0f;
+        agent_steps.font_scale = small_font_scale;
+
+        evolve_time.setTitle("Evolve phase (ms)");
+        evolve_time.setColor({231, 111, 81});
+        evolve_time.chart.base_extremes = {0.0f, 0.0f};
+        evolve_time.chart.values.setMaxValuesCount(200);
+        evolve_time.height_round = 1.0f;
+        evolve_time.font_scale = small_font_scale;
+
+        workers.setTitle("Workers busy (%)");
+        workers.setColor({100, 170, 255});
+        workers.tick_x_period = 1;
+        workers.label_callback = [](uint32_t i) {
+            return toString(i);
+        };
+        workers.current_value_callback = [](float x) {
+            return "avg " + toString(x, 1) + " %";
+        };
+
+        frame_time.setTitle("Frame time (ms)");
+        frame_time.setColor({244, 162, 97});
+        frame_time.chart.base_extremes = {0.0f, 0.0f};
+        frame_time.chart.values.setMaxValuesCount(200);
+        frame_time.height_round = 1.0f;
+        frame_time.font_scale = small_font_scale;
+    }
+
+    void setPosition(Vec2 position_)
+    {
+        position = position_;
+        float const dy = graph_size.y + card_margin;
+        generations.setPosition(position);
+        agent_steps.setPosition(position + Vec2{0.0f, dy});
+        evolve_time.setPosition(position + Vec2{0.0f, 2.0f * dy});
+        workers.setPosition(position + Vec2{0.0f, 3.0f * dy});
+        frame_time.setPosition(position + Vec2{0.0f, 4.0f * dy});
+    }
+
+    void addMetrics(PerformanceMetrics const& metrics)
+    {
+        generations.addValue(metrics.generations_per_second);
+        agent_steps.addValue(metrics.agent_steps_per_second * 1.0e-6f);
+        evolve_time.addValue(metrics.evolve_ms);
+
+        // Worker bars are not a time series, they are replaced at each generation
+        auto const worker_count = static_cast<uint32_t>(metrics.workers_busy.size());
+        if (worker_count == 0) {
+            return;
+        }
+        workers.clear();
+        workers.chart.data.setMaxValuesCount(worker_count);
+        workers.chart.base_extremes = {0.0f, 100.0f};
+        for (float const busy : metrics.workers_busy) {
+            workers.chart.addValue(busy);
+        }
+        workers.last_value = metrics.pool_busy;
+    }
+
+    /// Called once per frame with the scheduler's smoothed stats
+    void addFrameStats(pez::render::FrameScheduler::Stats const& stats)
+    {
+        frame_time.addValue(stats.frame_time);
+        frame_time.setTitle("Frame (ms) update " + toString(stats.update_time, 1)
+                          + " render " + toString(stats.render_time, 1)
+                          + " idle " + toString(stats.idle_time, 1));
+        uint32_t const updates = stats.updates;
+        float const    fps     = stats.fps;
+        frame_time.current_value_callback = [updates, fps](float x) {
+            return toString(x, 1) + " ms, " + toString(fps, 0) + " fps, " + toString(updates) + " updates";
+        };
+    }
+
+    void prepare()
+    {
+        generations.prepare();
+        agent_steps.prepare();
+        evolve_time.prepare();
+        frame_time.prepare();
+    }
+
+    void render(pez::render::Context& context)
+    {
+        generations.render(context);
+        agent_steps.render(context);
+        evolve_time.render(context);
+        workers.render(context);
+        frame_time.render(context);
+    }
+};
@@ -68,6 +68,15 @@ namespace training
             demo_renderer.network_renderer.labels     = network_input_labels;
         }
 
+        void prepare() override
+        {
+            if (state.demo) {
+                demo_renderer.prepare();
+            } else {
+                training_renderer.prepare();
+            }
+        }
+
         void render(pez::render::Context& context) override
         {
             if (state.demo) {
@@ -13,6 +13,7 @@
 #include "user/training/demo.hpp"
 #include "user/training/render/time_state.hpp"
 #include "user/training/render/demo_renderer.hpp"
+#include "user/training/render/performance_state.hpp"
 
 #include "user/common/render/agent_renderer.hpp"
 
@@ -37,6 +38,8 @@ struct TrainingRenderer
 
     TimeState time_state;
 
+    PerformanceState performance;
+
     explicit
     TrainingRenderer()
         : state{pez::core::getSingleton<TrainingState>()}
@@ -44,6 +47,7 @@ struct TrainingRenderer
         , gravity_plot{graph_size}
         , friction_plot{graph_size}
         , time_state{{42, 157, 143}}
+        , performance{getPerformanceGraphSize()}
     {
         time_state.setFont(pez::resources::getFont("font"));
 
@@ -60,13 +64,13 @@ struct TrainingRenderer
         };
 
         float const graph_start_x = (render_size.x - (2.0f * graph_size.x + card_margin)) * 0.5f;
-        gravity_plot.chart.extremes = {0.0f, 0.0f};
+        gravity_plot.chart.base_extremes = {0.0f, 0.0f};
         gravity_plot.setColor({233, 196, 106});
         gravity_plot.chart.values.setMaxValuesCount(200);
         gravity_plot.setPosition({graph_start_x, fitness.position.y + fitness.size.y + card_margin});
         gravity_plot.setTitle("Gravity");
 
-        friction_plot.chart.extremes = {0.0f, 0.0f};
+        friction_plot.chart.base_extremes = {0.0f, 0.0f};
         friction_plot.setColor({231, 111, 81});
         friction_plot.chart.values.setMaxValuesCount(200);
         friction_plot.setPosition({graph_start_x + graph_size.x + card_margin, fitness.position.y + fitness.size.y + card_margin});
@@ -79,6 +83,23 @@ struct TrainingRenderer
         network_renderer.setFont(pez::resources::getFont("font"));
 
         time_state.setPosition({card_margin, card_margin});
+        performance.setPosition({card_margin, 2.0f * card_margin + time_state.size.y});
+    }
+
+    /// Builds the graphs geometry on the thread pool, one task per widget
+    void prepare()
+    {
+        auto& thread_pool = pez::core::getSingleton<tp::ThreadPool>();
+        thread_pool.addTask([&] {
+            gravity_plot.prepare();
+        });
+        thread_pool.addTask([&] {
+            friction_plot.prepare();
+        });
+        thread_pool.addTask([&] {
+            performance.prepare();
+        });
+        thread_pool.waitForCompletion();
     }
 
     void render(pez::render::Context& context)
@@ -92,16 +113,34 @@ struct TrainingRenderer
         gravity_plot.render(context);
         friction_plot.render(context);
 
+        performance.render(context);
+
         // Neural network
         if (!state.demo && state.iteration) {
-            updateNetwork(pez::core::get<AgentInfo>(0).generateNetwork());
+            AgentInfo& best = pez::core::get<AgentInfo>(0);
+            if (network_renderer.isOutdated(best.genome.topology_id, best.genome.values_id)) {
+                updateNetwork(best.generateNetwork());
+            }
             network_renderer.render(context);
         }
     }
 
-    void updateNetwork(nt::Network const& network)
+    /// Performance graphs fill the column on the left of the score graph
+    [[nodiscard]]
+    Vec2 getPerformanceGraphSize() const
     {
-        network_renderer.initialize(network);
+        Vec2 const  render_size = pez::render::getRenderSize();
+        float const width       = (render_size.x - 1.5f * graph_size.x) * 0.5f - 2.0f * card_margin;
+        float const start_y     = 2.0f * card_margin + time_state.size.y;
+        float const height      = (render_size.y - start_y) / 5.0f - card_margin;
+        return {width, height};
+    }
+
+    void updateNetwork(nt::Network&& network)
+    {
+        if (!network_renderer.setNetwork(std::move(network))) {
+            return;
+        }
         network_renderer.setPosition({(pez::render::getRenderSize().x - network_renderer.size.x) * 0.5f,
                                       gravity_plot.position.y + gravity_plot.size.y + card_margin});
     }
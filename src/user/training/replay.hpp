@@ -0,0 +1,349 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/common/async_writer.hpp"
+#include "engine/common/binary_io.hpp"
+#include "engine/common/mapped_file.hpp"
+
+#include "user/common/configuration.hpp"
+#include "user/training/scene.hpp"
+
+
+namespace training
+{
+
+/** Recording of the demo scenes, replayed without simulating them
+ *
+ *  Each frame stores the state of every recorded scene as a set of quantized fields, encoded as the
+ *  zigzag varint of their difference with the previous frame.
+ *  The file is a sequence of blocks, the first frame of a block is a keyframe encoded against zero
+ *  so that any block can be decoded on its own.
+ *  Block       | magic u32 | version u32 | scene count u32 | first frame u32 | frame count u32 | size u32 | checksum u64 | frames |
+ *  Frame       | Scene 0 fields | Scene 1 fields | ...
+ */
+struct Replay
+{
+    static constexpr uint32_t block_magic = 0x42504C52; // "RLPB"
+    static constexpr uint32_t version     = 1;
+    static constexpr uint64_t header_size = 32;
+
+    enum Field : uint32_t
+    {
+        Time,
+        CartX,
+        CartY,
+        Output,
+        DisturbanceTime,
+        Disturbance,
+        Flags,
+        // Position x, position y and angle of each segment
+        Segments,
+    };
+
+    static constexpr uint32_t field_count = Field::Segments + 3 * conf::sim::segments_count;
+
+    enum Flag : int64_t
+    {
+        EnableAI          = 1,
+        EnableDisturbance = 2,
+    };
+
+    // Quantization steps
+    static constexpr pbd::RealType time_step     = 1e-5;
+    static constexpr pbd::RealType position_step = 1.0 / 256.0;
+    static constexpr pbd::RealType angle_step    = 1e-5;
+    static constexpr pbd::RealType output_step   = 1e-5;
+
+    using Values = std::array<int64_t, field_count>;
+
+    [[nodiscard]]
+    static Values capture(Scene const& scene)
+    {
+        Values values{};
+        pbd::Vec2D const cart = scene.agent.system.drag_constraints[0].target;
+        values[Time]            = quantize(scene.current_time, time_step);
+        values[CartX]           = quantize(cart.x, position_step);
+        values[CartY]           = quantize(cart.y, position_step);
+        values[Output]          = quantize(scene.network.output.empty() ? 0.0 : scene.network.output[0], output_step);
+        values[DisturbanceTime] = quantize(scene.current_disturbance_time, time_step);
+        values[Disturbance]     = scene.current_disturbance;
+        values[Flags]           = (scene.enable_ai ? EnableAI : 0) | (scene.enable_disturbance ? EnableDisturbance : 0);
+        for (uint32_t i{0}; i < conf::sim::segments_count; ++i) {
+            auto const& object = scene.agent.system.objects[i];
+            values[Segments + 3 * i + 0] = quantize(object.position.x, position_step);
+            values[Segments + 3 * i + 1] = quantize(object.position.y, position_step);
+            values[Segments + 3 * i + 2] = quantize(object.angle, angle_step);
+        }
+        return values;
+    }
+
+    /// Sets the scene in the recorded state, only what is rendered is restored
+    static void apply(Values const& values, Scene& scene)
+    {
+        scene.current_time             = values[Time] * time_step;
+        scene.current_disturbance_time = values[DisturbanceTime] * time_step;
+        scene.current_disturbance      = static_cast<uint32_t>(values[Disturbance]);
+        scene.enable_ai                = values[Flags] & EnableAI;
+        scene.enable_disturbance       = values[Flags] & EnableDisturbance;
+        if (!scene.network.output.empty()) {
+            scene.network.output[0] = values[Output] * output_step;
+        }
+        scene.agent.system.drag_constraints[0].target = {values[CartX] * position_step, values[CartY] * position_step};
+        for (uint32_t i{0}; i < conf::sim::segments_count; ++i) {
+            auto& object = scene.agent.system.objects[i];
+            object.position      = {values[Segments + 3 * i] * position_step, values[Segments + 3 * i + 1] * position_step};
+            object.position_last = object.position;
+            object.angle         = values[Segments + 3 * i + 2] * angle_step;
+            object.angle_last    = object.angle;
+        }
+    }
+
+    [[nodiscard]]
+    static int64_t quantize(pbd::RealType value, pbd::RealType step)
+    {
+        return static_cast<int64_t>(std::llround(value / step));
+    }
+};
+
+/// Encodes the recorded scenes frame by frame and appends them to the file by blocks
+class ReplayWriter
+{
+public:
+    /// The file is truncated, the recording starts at frame 0
+    ReplayWriter(AsyncWriter& writer, std::string filename, uint32_t scene_count, uint32_t block_frames)
+        : m_writer{writer}
+        , m_filename{std::move(filename)}
+        , m_scene_count{scene_count}
+        , m_block_frames{block_frames}
+        , m_previous(scene_count)
+    {
+        m_writer.write(m_filename, {});
+        startBlock();
+    }
+
+    ~ReplayWriter()
+    {
+        flush();
+    }
+
+    ReplayWriter(ReplayWriter const&) = delete;
+    ReplayWriter& operator=(ReplayWriter const&) = delete;
+
+    /** Records the current state of the scenes
+     *
+     * @param get_scene Callback returning the Scene const& of an index
+     */
+    template<typename TGetScene>
+    void addFrame(TGetScene&& get_scene)
+    {
+        for (uint32_t s{0}; s < m_scene_count; ++s) {
+            Replay::Values const values = Replay::capture(get_scene(s));
+            Replay::Values&      previous = m_previous[s];
+            for (uint32_t f{0}; f < Replay::field_count; ++f) {
+                varint::writeI64(m_block, values[f] - previous[f]);
+            }
+            previous = values;
+        }
+        ++m_frame_count;
+        if (m_frame_count >= m_block_frames) {
+            flush();
+        }
+    }
+
+    /// Queues the pending frames, even if the block is not full
+    void flush()
+    {
+        if (m_frame_count == 0) {
+            return;
+        }
+        le::storeU32(m_block.data() + 16, m_frame_count);
+        le::storeU32(m_block.data() + 20, static_cast<uint32_t>(m_block.size() - Replay::header_size));
+        le::storeU64(m_block.data() + 24, computeChecksum(m_block.data() + Replay::header_size, m_block.size() - Replay::header_size));
+        m_writer.append(m_filename, std::move(m_block));
+
+        m_first_frame += m_frame_count;
+        startBlock();
+    }
+
+    [[nodiscard]]
+    std::string const& getFilename() const
+    {
+        return m_filename;
+    }
+
+    [[nodiscard]]
+    uint32_t getFrameCount() const
+    {
+        return m_first_frame + m_frame_count;
+    }
+
+private:
+    AsyncWriter& m_writer;
+    std::string  m_filename;
+    uint32_t     m_scene_count;
+    uint32_t     m_block_frames;
+    uint32_t     m_first_frame = 0;
+    uint32_t     m_frame_count = 0;
+
+    std::vector<char>           m_block;
+    std::vector<Replay::Values> m_previous;
+
+    void startBlock()
+    {
+        m_block.clear();
+        m_block.reserve(Replay::header_size + static_cast<uint64_t>(m_block_frames) * m_scene_count * Replay::field_count * 2);
+        le::writeU32(m_block, Replay::block_magic);
+        le::writeU32(m_block, Replay::version);
+        le::writeU32(m_block, m_scene_count);
+        le::writeU32(m_block, m_first_frame);
+        // Frame count, size and checksum placeholders
+        le::writeU32(m_block, 0);
+        le::writeU32(m_block, 0);
+        le::writeU64(m_block, 0);
+        // Keyframe
+        std::fill(m_previous.begin(), m_previous.end(), Replay::Values{});
+        m_frame_count = 0;
+    }
+};
+
+/** Memory-mapped access to a replay file.
+ *  Only the blocks headers are read when opening the file. Seeking decodes from the keyframe of the
+ *  frame's block, except when moving forward in the same block where only the new frames are decoded.
+ *  A truncated or corrupted block ends the readable part of the file.
+ */
+class ReplayReader
+{
+public:
+    explicit
+    ReplayReader(std::string const& filename)
+        : m_file{filename}
+    {
+        if (!m_file.isValid()) {
+            return;
+        }
+        const char* const data = m_file.getData();
+        uint64_t    const size = m_file.getSize();
+        uint64_t offset = 0;
+        while (size - offset >= Replay::header_size) {
+            const char* const header = data + offset;
+            if (le::readU32(header) != Replay::block_magic || le::readU32(header + 4) != Replay::version) {
+                break;
+            }
+            uint32_t const scene_count = le::readU32(header + 8);
+            if (m_blocks.empty()) {
+                m_scene_count = scene_count;
+            }
+            Block block;
+            block.first_frame = le::readU32(header + 12);
+            block.frame_count = le::readU32(header + 16);
+            block.offset      = offset + Replay::header_size;
+            block.size        = le::readU32(header + 20);
+            if (scene_count != m_scene_count || block.first_frame != m_frame_count || block.size > size - block.offset ||
+                le::readU64(header + 24) != computeChecksum(data + block.offset, block.size)) {
+                break;
+            }
+            m_blocks.push_back(block);
+            m_frame_count += block.frame_count;
+            offset = block.offset + block.size;
+        }
+        m_values.resize(m_scene_count);
+    }
+
+    ReplayReader(ReplayReader const&) = delete;
+    ReplayReader& operator=(ReplayReader const&) = delete;
+
+    [[nodiscard]]
+    bool isValid() const
+    {
+        return m_file.isValid() && m_frame_count > 0;
+    }
+
+    [[nodiscard]]
+    uint32_t getFrameCount() const
+    {
+        return m_frame_count;
+    }
+
+    [[nodiscard]]
+    uint32_t getSceneCount() const
+    {
+        return m_scene_count;
+    }
+
+    /// Decodes the frame, it has to be lower than the frame count
+    void seek(uint32_t frame)
+    {
+        uint32_t const block_idx = findBlock(frame);
+        Block const& block = m_blocks[block_idx];
+        if (block_idx != m_block || m_frame > frame || !m_cursor) {
+            m_block  = block_idx;
+            m_frame  = block.first_frame;
+            m_cursor = m_file.getData() + block.offset;
+            std::fill(m_values.begin(), m_values.end(), Replay::Values{});
+            decodeFrame(block);
+        }
+        while (m_frame < frame) {
+            ++m_frame;
+            decodeFrame(block);
+        }
+    }
+
+    /// State of the scene at the last seeked frame
+    [[nodiscard]]
+    Replay::Values const& getValues(uint32_t scene) const
+    {
+        return m_values[scene];
+    }
+
+private:
+    struct Block
+    {
+        uint64_t offset      = 0;
+        uint32_t size        = 0;
+        uint32_t first_frame = 0;
+        uint32_t frame_count = 0;
+    };
+
+    MappedFile         m_file;
+    std::vector<Block> m_blocks;
+    uint32_t           m_scene_count = 0;
+    uint32_t           m_frame_count = 0;
+
+    // Decoding state
+    std::vector<Replay::Values> m_values;
+    uint32_t    m_block  = 0;
+    uint32_t    m_frame  = 0;
+    const char* m_cursor = nullptr;
+
+    void decodeFrame(Block const& block)
+    {
+        const char* const end = m_file.getData() + block.offset + block.size;
+        for (auto& values : m_values) {
+            for (int64_t& v : values) {
+                int64_t delta = 0;
+                // The checksum was verified, this only happens if the writer had a bug
+                if (!varint::readI64(m_cursor, end, delta)) {
+                    return;
+                }
+                v += delta;
+            }
+        }
+    }
+
+    [[nodiscard]]
+    uint32_t findBlock(uint32_t frame) const
+    {
+        // Blocks are sorted by first frame
+        auto const it = std::upper_bound(m_blocks.begin(), m_blocks.end(), frame, [](uint32_t f, Block const& b) {
+            return f < b.first_frame;
+        });
+        return static_cast<uint32_t>(it - m_blocks.begin()) - 1;
+    }
+};
+
+}
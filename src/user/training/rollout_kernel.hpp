@@ -0,0 +1,273 @@
+#pragma once
+#include <array>
+#include <cmath>
+
+#include "user/common/configuration.hpp"
+#include "user/common/physic/solver.hpp"
+
+
+namespace training
+{
+
+/** Flat copy of the pendulum's solver state, stepped without going through the solver's objects.
+ *  The rotation of each body is computed once per angle change instead of building a transform matrix
+ *  for each world position, the operations are otherwise the same as pbd::Solver so the results are identical.
+ *  The agent is created by Agent::initialize: a chain of bodies, the first one dragged by the cart.
+ */
+struct RolloutKernel
+{
+    using RealType = pbd::RealType;
+    using Vec2D    = pbd::Vec2D;
+
+    static constexpr uint32_t body_count = conf::sim::segments_count;
+
+    struct Body
+    {
+        Vec2D    position           = {};
+        Vec2D    position_last      = {};
+        Vec2D    velocity           = {};
+        Vec2D    center_of_mass     = {};
+        RealType angle              = 0.0;
+        RealType angle_last         = 0.0;
+        RealType angular_velocity   = 0.0;
+        RealType inv_mass           = 1.0;
+        RealType inv_inertia_tensor = 1.0;
+        /// Rotation of the current angle
+        RealType cos                = 1.0;
+        RealType sin                = 0.0;
+
+        void updateRotation()
+        {
+            cos = std::cos(angle);
+            sin = std::sin(angle);
+        }
+
+        /// Same as pbd::Object::getWorldPosition, the coordinates go through a float vector there too
+        [[nodiscard]]
+        Vec2D getWorldPosition(Vec2D obj_coord) const
+        {
+            RealType const x  = static_cast<float>(obj_coord.x);
+            RealType const y  = static_cast<float>(obj_coord.y);
+            RealType const tx = (-(cos * center_of_mass.x) + sin * center_of_mass.y) + position.x;
+            RealType const ty = (-(sin * center_of_mass.x) - cos * center_of_mass.y) + position.y;
+            return {(cos * x - sin * y) + tx, (sin * x + cos * y) + ty};
+        }
+
+        [[nodiscard]]
+        RealType getGeneralizedInvMass(Vec2D r, Vec2D n) const
+        {
+            RealType const cross_product = MathVec2::cross(r, n);
+            return inv_mass + cross_product * inv_inertia_tensor * cross_product;
+        }
+
+        void applyPositionCorrection(Vec2D p, Vec2D r)
+        {
+            position += p * inv_mass;
+            angle    += MathVec2::cross(r, p) * inv_inertia_tensor;
+            updateRotation();
+        }
+    };
+
+    struct Pin
+    {
+        uint32_t body_1     = 0;
+        uint32_t body_2     = 0;
+        Vec2D    coord_1    = {};
+        Vec2D    coord_2    = {};
+        RealType compliance = 0.0;
+        RealType lambda     = 0.0;
+    };
+
+    struct Drag
+    {
+        uint32_t body       = 0;
+        Vec2D    coord      = {};
+        Vec2D    target     = {};
+        RealType compliance = 0.0;
+    };
+
+    std::array<Body, body_count>     bodies;
+    std::array<Pin, body_count - 1>  pins;
+    Drag                             drag;
+    /// Particles followed by the observations
+    Vec2D                            base_coord = {};
+    Vec2D                            tip_coord  = {};
+
+    Vec2D    gravity   = {};
+    RealType friction  = 0.0;
+    uint32_t sub_steps = 1;
+
+    void load(pbd::Solver const& solver)
+    {
+        for (uint32_t i{0}; i < body_count; ++i) {
+            pbd::Object const& object = solver.objects[i];
+            Body& body = bodies[i];
+            body.position           = object.position;
+            body.position_last      = object.position_last;
+            body.velocity           = object.velocity;
+            body.center_of_mass     = object.center_of_mass;
+            body.angle              = object.angle;
+            body.angle_last         = object.angle_last;
+            body.angular_velocity   = object.angular_velocity;
+            body.inv_mass           = object.inv_mass;
+            body.inv_inertia_tensor = object.inv_inertia_tensor;
+            body.updateRotation();
+        }
+        base_coord = solver.objects[0].particles[0];
+        tip_coord  = solver.objects[body_count - 1].particles[1];
+
+        pbd::DragConstraint const& drag_constraint = solver.drag_constraints[0];
+        drag.body       = static_cast<uint32_t>(drag_constraint.anchor.obj.getID());
+        drag.coord      = drag_constraint.anchor.obj_coord;
+        drag.target     = drag_constraint.target;
+        drag.compliance = drag_constraint.constraint.compliance;
+
+        uint32_t i{0};
+        for (pbd::ObjectPinConstraint const& pin_constraint : solver.object_pins) {
+            Pin& pin = pins[i++];
+            pin.body_1     = static_cast<uint32_t>(pin_constraint.anchor_1.obj.getID());
+            pin.body_2     = static_cast<uint32_t>(pin_constraint.anchor_2.obj.getID());
+            pin.coord_1    = pin_constraint.anchor_1.obj_coord;
+            pin.coord_2    = pin_constraint.anchor_2.obj_coord;
+            pin.compliance = pin_constraint.constraint.compliance;
+            pin.lambda     = pin_constraint.constraint.lambda;
+        }
+
+        gravity   = solver.gravity;
+        friction  = solver.friction;
+        sub_steps = solver.sub_steps;
+    }
+
+    /// Writes back the state that changes while stepping
+    void store(pbd::Solver& solver) const
+    {
+        for (uint32_t i{0}; i < body_count; ++i) {
+            pbd::Object& object = solver.objects[i];
+            Body const&  body   = bodies[i];
+            object.position         = body.position;
+            object.position_last    = body.position_last;
+            object.velocity         = body.velocity;
+            object.angle            = body.angle;
+            object.angle_last       = body.angle_last;
+            object.angular_velocity = body.angular_velocity;
+        }
+        solver.drag_constraints[0].target = drag.target;
+        uint32_t i{0};
+        for (pbd::ObjectPinConstraint& pin_constraint : solver.object_pins) {
+            pin_constraint.constraint.lambda = pins[i++].lambda;
+        }
+    }
+
+    [[nodiscard]]
+    Vec2D getBasePosition() const
+    {
+        return bodies[0].getWorldPosition(base_coord);
+    }
+
+    [[nodiscard]]
+    Vec2D getTipPosition() const
+    {
+        return bodies[body_count - 1].getWorldPosition(tip_coord);
+    }
+
+    [[nodiscard]]
+    Vec2D getDirection(uint32_t i) const
+    {
+        return {bodies[i].cos, bodies[i].sin};
+    }
+
+    [[nodiscard]]
+    RealType getAngularVec(uint32_t i) const
+    {
+        return bodies[i].angular_velocity;
+    }
+
+    Vec2D& getCartTarget()
+    {
+        return drag.target;
+    }
+
+    /// Same as Agent::applyDisturbance
+    void applyDisturbance(Vec2D d)
+    {
+        bodies[1].applyPositionCorrection(d, {conf::sim::segment_size * 0.5, 0.0});
+    }
+
+    /// Same as pbd::Solver::update
+    void update(RealType dt)
+    {
+        RealType const sub_dt{dt / to<RealType>(sub_steps)};
+        for (uint32_t s{sub_steps}; s--;) {
+            for (Body& body : bodies) {
+                Vec2D const forces = gravity / body.inv_mass;
+                body.position_last = body.position;
+                body.velocity      = body.velocity + sub_dt * forces * body.inv_mass;
+                body.position      = body.position + body.velocity * sub_dt;
+                body.angle_last    = body.angle;
+                body.angle         = body.angle + body.angular_velocity * sub_dt;
+                body.updateRotation();
+            }
+
+            for (Pin& pin : pins) {
+                pin.lambda = 0.0;
+            }
+            solveDrag(sub_dt);
+            for (Pin& pin : pins) {
+                solvePin(pin, sub_dt);
+            }
+
+            for (Body& body : bodies) {
+                body.velocity         = (body.position - body.position_last) / sub_dt * (1.0 - friction);
+                body.angular_velocity = (body.angle - body.angle_last)       / sub_dt * (1.0 - friction);
+            }
+        }
+    }
+
+    void solveDrag(RealType dt)
+    {
+        Body& body = bodies[drag.body];
+        Vec2D const pa = body.getWorldPosition(drag.coord);
+        Vec2D const r1 = pa - body.position;
+
+        Vec2D const    v = (drag.target - pa);
+        RealType const d = MathVec2::length(v);
+        if (d == 0.0) {
+            return;
+        }
+        Vec2D const n = v / d;
+
+        RealType const w1           = body.getGeneralizedInvMass(r1, n);
+        RealType const a            = drag.compliance / (dt * dt);
+        RealType const delta_lambda = d / (w1 + 0.0 + a);
+        body.applyPositionCorrection(delta_lambda * n, r1);
+    }
+
+    void solvePin(Pin& pin, RealType dt)
+    {
+        Body& body_1 = bodies[pin.body_1];
+        Body& body_2 = bodies[pin.body_2];
+        Vec2D const anchor_1_world_position = body_1.getWorldPosition(pin.coord_1);
+        Vec2D const anchor_2_world_position = body_2.getWorldPosition(pin.coord_2);
+        Vec2D const r1 = anchor_1_world_position - body_1.position;
+        Vec2D const r2 = anchor_2_world_position - body_2.position;
+
+        Vec2D const    v = anchor_1_world_position - anchor_2_world_position;
+        RealType const d = MathVec2::length(v);
+        if (d == 0.0) {
+            return;
+        }
+        Vec2D const n = v / d;
+
+        RealType const w1           = body_1.getGeneralizedInvMass(r1, n);
+        RealType const w2           = body_2.getGeneralizedInvMass(r2, -n);
+        RealType const a            = pin.compliance / (dt * dt);
+        RealType const delta_lambda = (d - a * pin.lambda) / (w1 + w2 + a);
+        pin.lambda += delta_lambda;
+
+        Vec2D const p = delta_lambda * n;
+        body_1.applyPositionCorrection(-p, r1);
+        body_2.applyPositionCorrection( p, r2);
+    }
+};
+
+}
@@ -2,12 +2,16 @@
 #include <functional>
 #include "user/common/agent.hpp"
 #include "user/common/neat/network_generator.hpp"
+#include "user/common/neat/layered_executor.hpp"
+#include "user/common/neat/quantized_network.hpp"
+#include "user/common/neat/network_jit.hpp"
 #include "user/common/physic/configuration.hpp"
 #include "user/common/disturbances.hpp"
 
 #include "user/training/task.hpp"
 #include "user/training/training_state.hpp"
 #include "user/training/agent_info.hpp"
+#include "user/training/rollout_kernel.hpp"
 
 
 namespace training
@@ -25,9 +29,25 @@ struct Scene : public training::Task
     TrainingState::IterationConfiguration configuration;
 
     bool enable_ai = true;
+    /// Accuracy of the network's activation functions
+    nt::ActivationTier activation_tier = nt::ActivationTier::Exact;
+    /// How the network is evaluated, the connections values used for rendering are only updated by Gather
+    nt::ExecutionMode   execution_mode  = nt::ExecutionMode::Gather;
+    /// Set when the network is rendered
+    bool                record_connection_values = false;
+    /// Mode used for the current iteration, never Auto
+    nt::ExecutionMode   active_execution_mode = nt::ExecutionMode::Gather;
+    nt::LayeredExecutor layered_executor;
+    nt::QuantizedNetwork<int16_t> network_int16;
+    nt::QuantizedNetwork<int8_t>  network_int8;
+    nt::NetworkJit                network_jit;
 
     nt::Network network;
     Agent       agent;
+    /// Copy of the agent's state stepped when use_rollout_kernel is set, written back to the agent after each update
+    RolloutKernel rollout;
+    bool          use_rollout_kernel = conf::sim::use_rollout_kernel;
+    std::vector<nt::conf::RealType> network_inputs;
 
     // Disturbances
     bool          enable_disturbance       = false;
@@ -72,32 +92,56 @@ struct Scene : public training::Task
         agent.system.gravity   = {0.0f, configuration.solver_gravity};
         agent.system.friction  = configuration.solver_friction;
         agent.system.sub_steps = configuration.solver_sub_steps;
+        rollout.load(agent.system);
 
         auto& agent_info = getAgentInfo();
         // Reset score
         agent_info.score = 0.0f;
         // Update the network
-        network = agent_info.generateNetwork();
+        agent_info.updateNetwork(network, activation_tier);
+        network.record_values = record_connection_values;
+        active_execution_mode = resolveExecutionMode();
+        if (active_execution_mode == nt::ExecutionMode::Layered && !layered_executor.isUpToDate(network)) {
+            layered_executor.build(network);
+        } else if (active_execution_mode == nt::ExecutionMode::Int16 && !network_int16.isUpToDate(network)) {
+            network_int16.build(network);
+        } else if (active_execution_mode == nt::ExecutionMode::Int8 && !network_int8.isUpToDate(network)) {
+            network_int8.build(network);
+        } else if (active_execution_mode == nt::ExecutionMode::Jit && !network_jit.isUpToDate(network)) {
+            network_jit.compile(network);
+        }
         enable_ai = true;
     }
 
     void update(pbd::RealType dt) override
+    {
+        if (use_rollout_kernel) {
+            update(rollout, dt);
+            rollout.store(agent.system);
+        } else {
+            update(agent, dt);
+        }
+    }
+
+    /// Steps the simulation, the state is either the agent or the rollout kernel
+    template<typename TState>
+    void update(TState& state, pbd::RealType dt)
     {
         auto const sub_dt = dt / static_cast<nt::conf::RealType>(configuration.task_sub_steps);
         for (uint32_t i{configuration.task_sub_steps}; i--;) {
 
             if (current_time >= freeze_time) {
                 // Execute NN
-                updateAI(sub_dt);
+                updateAI(state, sub_dt);
                 // Update physics
-                agent.update(sub_dt);
+                state.update(sub_dt);
             }
 
             // Update disturbance only when outside freeze time
             if (enable_disturbance) {
                 if (current_time >= (freeze_time + disturbance_freeze_time)) {
                     current_disturbance_time += sub_dt;
-                    updateDisturbances(dt);
+                    updateDisturbances(state, dt);
                 }
             }
 
@@ -105,18 +149,19 @@ struct Scene : public training::Task
         }
     }
 
-    void updateAI(pbd::RealType dt)
+    template<typename TState>
+    void updateAI(TState& state, pbd::RealType dt)
     {
-        pbd::RealType const   pos_x     = (agent.getBasePosition().x - conf::sim::world_size.x * 0.5f) / (conf::sim::slider_length * 0.5f);
-        Agent::Vec2Real const dir_1     = agent.getDirection(0);
-        pbd::RealType const   ang_vel_1 = agent.getAngularVec(0);
-        Agent::Vec2Real const dir_2     = agent.getDirection(1);
-        pbd::RealType const   ang_vel_2 = agent.getAngularVec(1);
+        pbd::RealType const   pos_x     = (state.getBasePosition().x - conf::sim::world_size.x * 0.5f) / (conf::sim::slider_length * 0.5f);
+        Agent::Vec2Real const dir_1     = state.getDirection(0);
+        pbd::RealType const   ang_vel_1 = state.getAngularVec(0);
+        Agent::Vec2Real const dir_2     = state.getDirection(1);
+        pbd::RealType const   ang_vel_2 = state.getAngularVec(1);
         pbd::RealType const   dot_1_2   = MathVec2::dot(dir_1, dir_2);
 
         if (enable_ai) {
             if (conf::net::control_type == conf::ControlType::Acceleration) {
-                network.execute({
+                network_inputs.assign({
                                         pos_x,
                                         current_velocity / configuration.max_speed,
                                         dir_1.x,
@@ -127,9 +172,10 @@ struct Scene : public training::Task
                                         ang_vel_2 * dt,
                                         dot_1_2
                                 });
+                executeNetwork(network_inputs);
                 update_velocity(network.output[0] * configuration.max_accel * dt);
             } else {
-                network.execute({
+                network_inputs.assign({
                                         pos_x,
                                         dir_1.x,
                                         dir_1.y,
@@ -139,13 +185,14 @@ struct Scene : public training::Task
                                         ang_vel_2 * dt,
                                         dot_1_2
                                 });
+                executeNetwork(network_inputs);
                 current_velocity = network.output[0] * configuration.max_speed;
             }
-            updateCartPosition(dt);
+            updateCartPosition(state.getCartTarget(), dt);
         }
 
         pbd::RealType const delta = std::abs(network.output[0] - last_out);
-        pbd::RealType const pos_y = agent.getTipPosition().y;
+        pbd::RealType const pos_y = state.getTipPosition().y;
 
         last_out = network.output[0];
         out_sum  += delta;
@@ -161,6 +208,44 @@ struct Scene : public training::Task
         }
     }
 
+    [[nodiscard]]
+    nt::ExecutionMode resolveExecutionMode() const
+    {
+        // Only the gather execution records connections values
+        if (record_connection_values) {
+            return nt::ExecutionMode::Gather;
+        }
+        if (execution_mode == nt::ExecutionMode::Auto) {
+            // The dense layers change the summation order, scores can differ from Gather by rounding
+            bool const wide = nt::LayeredExecutor::getMaxLayerSize(network) >= conf::net::layered_min_layer_size;
+            return wide ? nt::ExecutionMode::Layered : nt::ExecutionMode::Gather;
+        }
+        return execution_mode;
+    }
+
+    void executeNetwork(std::vector<nt::conf::RealType> const& inputs)
+    {
+        switch (active_execution_mode) {
+        case nt::ExecutionMode::Layered:
+            layered_executor.execute(network, inputs);
+            break;
+        case nt::ExecutionMode::Int16:
+            network_int16.execute(inputs);
+            network.output = network_int16.getResult();
+            break;
+        case nt::ExecutionMode::Int8:
+            network_int8.execute(inputs);
+            network.output = network_int8.getResult();
+            break;
+        case nt::ExecutionMode::Jit:
+            network_jit.execute(network, inputs);
+            break;
+        default:
+            network.execute(inputs);
+            break;
+        }
+    }
+
     void update_velocity(pbd::RealType accel)
     {
         current_velocity += accel;
@@ -171,30 +256,30 @@ struct Scene : public training::Task
         }
     }
 
-    void updateCartPosition(pbd::RealType dt)
+    void updateCartPosition(pbd::Vec2D& target, pbd::RealType dt)
     {
-        auto& cart = agent.system.drag_constraints[0];
-        cart.target.x += current_velocity * dt;
+        target.x += current_velocity * dt;
 
         // Handle limits
         float const min_pos = conf::sim::world_size.x * 0.5f - conf::sim::slider_length * 0.5f;
         float const max_pos = conf::sim::world_size.x * 0.5f + conf::sim::slider_length * 0.5f;
 
-        if (cart.target.x < min_pos) {
-            cart.target.x = min_pos;
+        if (target.x < min_pos) {
+            target.x = min_pos;
             current_velocity = 0.0f;
         }
-        if (cart.target.x > max_pos) {
-            cart.target.x = max_pos;
+        if (target.x > max_pos) {
+            target.x = max_pos;
             current_velocity = 0.0f;
         }
     }
 
-    void updateDisturbances(pbd::RealType dt)
+    template<typename TState>
+    void updateDisturbances(TState& state, pbd::RealType dt)
     {
         Disturbances::Push const& push = getCurrentPush();
         if (isActive(push)) {
-            agent.applyDisturbance({push.force * dt, 0.0});
+            state.applyDisturbance({push.force * dt, 0.0});
             if (isOver(push)) {
                 ++current_disturbance;
                 current_disturbance_time = 0.0f;
@@ -1,9 +1,15 @@
 #pragma once
 #include <filesystem>
+#include <unordered_map>
 
 #include "engine/engine.hpp"
+#include "engine/common/async_writer.hpp"
 
+#include "user/training/checkpoint.hpp"
+#include "user/training/genome_log.hpp"
+#include "user/training/telemetry.hpp"
 #include "user/training/training_state.hpp"
+#include "user/training/performance_metrics.hpp"
 #include "user/training/evolver.hpp"
 #include "user/training/demo.hpp"
 #include "user/training/scene.hpp"
@@ -19,6 +25,14 @@ struct Stadium : public pez::core::IProcessor
     tp::ThreadPool& thread_pool;
     Evolver         evolver;
 
+    PerformanceMetrics metrics;
+
+    std::string const checkpoint_filename = "checkpoint.bin";
+    AsyncWriter       async_writer;
+    GenomeLog         genome_log;
+
+    training::TelemetryWriter telemetry;
+
     float target_score = 8.0f;
 
     bool bypass_score_threshold = false;
@@ -26,6 +40,8 @@ struct Stadium : public pez::core::IProcessor
     Stadium()
         : state{pez::core::getSingleton<TrainingState>()}
         , thread_pool{pez::core::getSingleton<tp::ThreadPool>()}
+        // The file is set when the exploration starts
+        , telemetry{async_writer, "", conf::exp::telemetry_block_size}
     {
         // Create agents info
         pez::core::createMultiple<AgentInfo>(conf::sel::population_size);
@@ -37,6 +53,8 @@ struct Stadium : public pez::core::IProcessor
             auto task = pez::core::createGetRef<training::Scene>(i, 1);
             task->enable_disturbance = false;
             task->freeze_time = 0.0;
+            task->activation_tier = conf::net::training_activation_tier;
+            task->execution_mode  = conf::net::training_execution_mode;
             // Set the task's score function
             task->score_function = [](pbd::RealType pos_x, pbd::RealType out_sum, pbd::RealType dist_sum) {
                 pbd::RealType const dist_to_center_penalty = std::abs(1.0 - std::abs(pos_x));
@@ -58,11 +76,41 @@ struct Stadium : public pez::core::IProcessor
         restartExploration();
     }
 
+    ~Stadium()
+    {
+        // Write the last incomplete telemetry block
+        telemetry.flush();
+    }
+
     /// Loads genome and configuration for the provided generation
     void loadContext(uint32_t gen, bool force_demo = false)
     {
-        loadGenome("best_" + toString(gen) + ".bin", force_demo);
-        loadConf("best_conf_" + toString(gen) + ".bin");
+        // Ensure pending saves are on disk
+        async_writer.flush();
+        std::string const genome_filename = "best_" + toString(gen) + ".bin";
+        if (std::filesystem::exists(genome_filename)) {
+            loadGenome(genome_filename, force_demo);
+            loadConf("best_conf_" + toString(gen) + ".bin");
+            return;
+        }
+
+        // Fallback on the genome log of the current exploration
+        std::vector<char> payload;
+        if (!GenomeLog::find(getCurrentFolder(), gen, payload)) {
+            std::cout << "Cannot find genome of generation " << gen << std::endl;
+            return;
+        }
+        BinaryBufferReader reader{payload.data(), payload.size()};
+        nt::Genome genome;
+        genome.decode(reader);
+        state.configuration.read(reader);
+        if (!reader.isValid()) {
+            std::cout << "Invalid genome log record for generation " << gen << std::endl;
+            return;
+        }
+        pez::core::foreach<AgentInfo>([&genome](AgentInfo& a) { a.genome = genome; });
+        state.demo = force_demo;
+        printConfiguration();
     }
 
     /** Loads the genome stored in the specified file
@@ -84,30 +132,56 @@ struct Stadium : public pez::core::IProcessor
     }
 
     /// Dumps all the genomes of the current generation
-    void writeAllGenomes() const
+    void writeAllGenomes()
     {
         std::string const path_prefix = getCurrentFolder() + "/dump_" + toString(state.iteration);
-        std::filesystem::create_directories(path_prefix);
+        async_writer.createDirectories(path_prefix);
 
         for (uint32_t i{0}; i < conf::sel::population_size; ++i) {
-            pez::core::get<AgentInfo>(0).genome.writeToFile(path_prefix + "/genome_" + toString(i) + ".bin");
+            std::vector<char> data;
+            pez::core::get<AgentInfo>(i).genome.encode(data);
+            async_writer.write(path_prefix + "/genome_" + toString(i) + ".bin", std::move(data));
         }
         saveConfiguration(path_prefix + "/configuration.bin");
     }
 
+    /// Serializes the whole population and writes it in the background
+    void saveCheckpoint()
+    {
+        async_writer.write(checkpoint_filename, training::Checkpoint::create());
+    }
+
+    /** Restores the population from the last checkpoint, training resumes at the saved iteration
+     *
+     * @return false if the checkpoint cannot be loaded, the current population is then kept
+     */
+    bool loadCheckpoint()
+    {
+        // Ensure no checkpoint is being written while reading it
+        async_writer.flush();
+        if (!training::Checkpoint::load(checkpoint_filename)) {
+            return false;
+        }
+        async_writer.createDirectories(getCurrentFolder());
+        telemetry.setFilename(getTelemetryFilename());
+        // Wait for the folder creation before scanning the existing segments
+        async_writer.flush();
+        genome_log.reset(getCurrentFolder(), false);
+        state.demo = false;
+        return true;
+    }
+
     /// Load the training configuration stored in the file
     void loadConf(std::string const& filename)
     {
         // Load configuration
         BinaryReader conf_reader{filename};
-        conf_reader.readInto(state.configuration.max_speed);
-        conf_reader.readInto(state.configuration.max_accel);
-        conf_reader.readInto(state.configuration.solver_friction);
-        conf_reader.readInto(state.configuration.solver_gravity);
-        conf_reader.readInto(state.configuration.solver_sub_steps);
-        conf_reader.readInto(state.configuration.solver_compliance);
-        conf_reader.readInto(state.configuration.task_sub_steps);
+        state.configuration.read(conf_reader);
+        printConfiguration();
+    }
 
+    void printConfiguration() const
+    {
         std::cout << "[Conf loaded]" << std::endl;
         std::cout << "  Gravity: "     << state.configuration.solver_gravity << std::endl;
         std::cout << "  Friction: "    << state.configuration.solver_friction << std::endl;
@@ -127,21 +201,52 @@ struct Stadium : public pez::core::IProcessor
         }
         // Update state, increases iteration counter and automatically switches to demo mode if needed
         state.addIteration();
+        metrics.startGeneration();
         // Run all tasks
-        executeTasks(dt);
+        metrics.startSimulation(thread_pool);
+        uint64_t const agent_steps = executeTasks(dt);
+        metrics.endSimulation(thread_pool, agent_steps);
         // After all tasks has been completed, create the next generation
+        metrics.startEvolve();
         evolver.createNewGeneration();
+        metrics.endEvolve();
         state.iteration_best_score = pez::core::get<AgentInfo>(0).score;
+        addTelemetryRow();
         // Check if we need to restart exploration
         if (needIncreaseDifficulty()) {
             increaseDifficulty();
         } else if (state.iteration % 10 == 0) {
             saveBest(true);
         }
+        if (state.iteration % conf::exp::checkpoint_period == 0) {
+            saveCheckpoint();
+        }
         auto& renderer = pez::core::getRenderer<training::Renderer>();
         renderer.training_renderer.gravity_plot.addValue(to<float>(state.configuration.solver_gravity));
         renderer.training_renderer.friction_plot.addValue(to<float>(state.configuration.solver_friction));
         renderer.training_renderer.fitness.addValue(to<float>(pez::core::get<AgentInfo>(0).score));
+        renderer.training_renderer.performance.addMetrics(metrics);
+    }
+
+    void addTelemetryRow()
+    {
+        using Column = training::Telemetry::Column;
+        Evolver::Stats const& stats = evolver.stats;
+        training::Telemetry::Row row;
+        row.set(Column::Iteration, state.iteration);
+        row.set(Column::BestScore, stats.best_score);
+        row.set(Column::MeanScore, stats.mean_score);
+        row.set(Column::Score90, stats.score_90);
+        row.set(Column::Score50, stats.score_50);
+        row.set(Column::Score10, stats.score_10);
+        row.set(Column::ConnectionsMean, stats.connections_mean);
+        row.set(Column::ConnectionsMax, stats.connections_max);
+        row.set(Column::NodesMean, stats.nodes_mean);
+        row.set(Column::Gravity, to<float>(state.configuration.solver_gravity));
+        row.set(Column::Friction, to<float>(state.configuration.solver_friction));
+        row.set(Column::SimulationMs, metrics.simulation_ms);
+        row.set(Column::EvolveMs, metrics.evolve_ms);
+        telemetry.addRow(row);
     }
 
     /// Initializes the iteration
@@ -149,28 +254,71 @@ struct Stadium : public pez::core::IProcessor
     {
         // Only change the training sequence
         pez::core::get<Disturbances>(1).generateSequence();
+        shareNetworks();
         // Initialize tasks
         pez::core::parallelForeach<training::Scene>([&](training::Scene& task) {
             // Set the push sequence to the training one
             task.push_sequence_id = 1;
+            // The demo may have switched the tasks to the exact tier and the gather path
+            task.record_connection_values = false;
+            task.activation_tier  = conf::net::training_activation_tier;
+            task.execution_mode   = conf::net::training_execution_mode;
             task.initialize();
         });
     }
 
-    /// Runs all tasks until maximum time is reached
-    void executeTasks(float dt)
+    /** Agents' genomes come from any agent of the previous generation, to avoid a full rebuild
+     *  each task takes a network compiled from the same topology, if any, that then only needs to be patched
+     */
+    static void shareNetworks()
+    {
+        auto& tasks = pez::core::getData<training::Scene>().getData();
+        auto const tasks_count = static_cast<uint32_t>(tasks.size());
+
+        std::unordered_map<uint64_t, uint32_t> task_by_topology;
+        for (uint32_t i{0}; i < tasks_count; ++i) {
+            task_by_topology.emplace(tasks[i].network.topology_id, i);
+        }
+
+        // Copy first, networks of the previous generation must not be overwritten while being shared
+        std::vector<std::pair<uint32_t, nt::Network>> shared;
+        for (uint32_t i{0}; i < tasks_count; ++i) {
+            uint64_t const topology_id = tasks[i].getAgentInfo().genome.topology_id;
+            if (tasks[i].network.topology_id == topology_id) {
+                continue;
+            }
+            auto const it = task_by_topology.find(topology_id);
+            if (it != task_by_topology.end()) {
+                shared.emplace_back(i, tasks[it->second].network);
+            }
+        }
+        for (auto& [i, network] : shared) {
+            tasks[i].network = std::move(network);
+        }
+    }
+
+    /// Runs all tasks until maximum time is reached, returns the number of agent steps performed
+    uint64_t executeTasks(float dt)
     {
         initializeIteration();
+        return runTasks(dt);
+    }
 
+    /// Runs the already initialized tasks
+    uint64_t runTasks(float dt)
+    {
+        std::atomic<uint64_t> agent_steps{0};
         uint32_t const tasks_count = pez::core::getCount<training::Scene>();
         auto&          tasks       = pez::core::getData<training::Scene>().getData();
         thread_pool.dispatch(tasks_count, [&](uint32_t start, uint32_t end) {
+            uint64_t steps = 0;
             float t = 0.0f;
             while (t < conf::sel::max_iteration_time) {
                 bool done = true;
                 for (uint32_t i{start}; i < end; ++i) {
                     if (!tasks[i].done()) {
                         tasks[i].update(dt);
+                        steps += tasks[i].configuration.task_sub_steps;
                         done = false;
                     }
                 }
@@ -179,29 +327,155 @@ struct Stadium : public pez::core::IProcessor
                 }
                 t += dt;
             }
+            agent_steps += steps;
+        });
+        return agent_steps;
+    }
+
+    /// Evaluates the current population using the provided activation functions and execution mode, returns the scores
+    std::vector<pbd::RealType> evaluatePopulation(nt::ActivationTier tier, nt::ExecutionMode mode, float dt)
+    {
+        pez::core::parallelForeach<training::Scene>([&](training::Scene& task) {
+            task.activation_tier  = tier;
+            task.execution_mode   = mode;
+            task.push_sequence_id = 1;
+            task.initialize();
+        });
+        runTasks(dt);
+
+        std::vector<pbd::RealType> scores;
+        scores.reserve(conf::sel::population_size);
+        pez::core::foreach<AgentInfo>([&](AgentInfo const& a) { scores.push_back(a.score); });
+        return scores;
+    }
+
+    /** Evaluates the population with each activation tier and prints how far the scores are from the exact ones,
+     *  to check that a faster tier can be used for training without changing the selection.
+     *  The scores and the training's tier are restored afterward.
+     */
+    void compareActivationTiers(float dt)
+    {
+        std::vector<pbd::RealType> saved_scores;
+        pez::core::foreach<AgentInfo>([&](AgentInfo const& a) { saved_scores.push_back(a.score); });
+
+        auto const getBest = [](std::vector<pbd::RealType> const& scores) {
+            return std::max_element(scores.begin(), scores.end()) - scores.begin();
+        };
+
+        Stopwatch stopwatch;
+        auto const exact = evaluatePopulation(nt::ActivationTier::Exact, conf::net::training_execution_mode, dt);
+        float const exact_ms = stopwatch.getElapsedMs();
+        std::cout << "[Activation tiers] Exact: " << exact_ms << " ms" << std::endl;
+
+        for (auto const tier : {nt::ActivationTier::Fast, nt::ActivationTier::Table}) {
+            stopwatch.reset();
+            auto const scores = evaluatePopulation(tier, conf::net::training_execution_mode, dt);
+            float const elapsed_ms = stopwatch.getElapsedMs();
+
+            pbd::RealType error_sum = 0.0;
+            pbd::RealType error_max = 0.0;
+            for (uint32_t i{0}; i < scores.size(); ++i) {
+                pbd::RealType const error = std::abs(scores[i] - exact[i]);
+                error_sum += error;
+                error_max  = std::max(error_max, error);
+            }
+            std::cout << "  " << (tier == nt::ActivationTier::Fast ? "Fast" : "Table") << ": " << elapsed_ms << " ms"
+                      << " Mean score error: " << error_sum / to<pbd::RealType>(scores.size())
+                      << " Max score error: "  << error_max
+                      << " Same best: "        << (getBest(scores) == getBest(exact) ? "yes" : "no") << std::endl;
+        }
+
+        // Restore the training state
+        uint32_t i{0};
+        pez::core::foreach<AgentInfo>([&](AgentInfo& a) { a.score = saved_scores[i++]; });
+        pez::core::foreach<training::Scene>([](training::Scene& task) {
+            task.activation_tier = conf::net::training_activation_tier;
+        });
+    }
+
+    /** Evaluates the population with the quantized networks and compares the scores with the exact double precision ones.
+     *  A per genome report is written in quantization_report.csv, the training state is restored afterward.
+     */
+    void compareQuantization(float dt)
+    {
+        std::vector<pbd::RealType> saved_scores;
+        pez::core::foreach<AgentInfo>([&](AgentInfo const& a) { saved_scores.push_back(a.score); });
+
+        // Relative score difference under which the quantized network is considered equivalent
+        pbd::RealType const tolerance = 0.01;
+
+        Stopwatch stopwatch;
+        auto const reference = evaluatePopulation(nt::ActivationTier::Exact, nt::ExecutionMode::Gather, dt);
+        std::cout << "[Quantization] Double: " << stopwatch.getElapsedMs() << " ms" << std::endl;
+
+        std::vector<std::vector<pbd::RealType>> results;
+        for (auto const mode : {nt::ExecutionMode::Int16, nt::ExecutionMode::Int8}) {
+            stopwatch.reset();
+            results.push_back(evaluatePopulation(nt::ActivationTier::Exact, mode, dt));
+            float const elapsed_ms = stopwatch.getElapsedMs();
+
+            auto const& scores = results.back();
+            pbd::RealType delta_sum = 0.0;
+            pbd::RealType delta_max = 0.0;
+            uint32_t      within_tolerance = 0;
+            for (uint32_t i{0}; i < scores.size(); ++i) {
+                pbd::RealType const delta = std::abs(scores[i] - reference[i]);
+                delta_sum += delta;
+                delta_max  = std::max(delta_max, delta);
+                within_tolerance += (delta <= tolerance * std::max(std::abs(reference[i]), pbd::RealType{1.0}));
+            }
+            std::cout << "  " << (mode == nt::ExecutionMode::Int16 ? "Int16" : "Int8") << ": " << elapsed_ms << " ms"
+                      << " Mean score delta: " << delta_sum / to<pbd::RealType>(scores.size())
+                      << " Max score delta: "  << delta_max
+                      << " Within tolerance: " << within_tolerance << "/" << scores.size() << std::endl;
+        }
+
+        std::string report = "genome,connections,double,int16,int8,delta_int16,delta_int8\n";
+        for (uint32_t i{0}; i < reference.size(); ++i) {
+            report += toString(i) + "," + toString(pez::core::get<AgentInfo>(i).genome.connections.size()) + ","
+                    + toString(reference[i], 6) + "," + toString(results[0][i], 6) + "," + toString(results[1][i], 6) + ","
+                    + toString(results[0][i] - reference[i], 6) + "," + toString(results[1][i] - reference[i], 6) + "\n";
+        }
+        async_writer.write("quantization_report.csv", std::vector<char>(report.begin(), report.end()));
+
+        // Restore the training state
+        uint32_t i{0};
+        pez::core::foreach<AgentInfo>([&](AgentInfo& a) { a.score = saved_scores[i++]; });
+        pez::core::foreach<training::Scene>([](training::Scene& task) {
+            task.activation_tier = conf::net::training_activation_tier;
+            task.execution_mode  = conf::net::training_execution_mode;
         });
     }
 
     /// Saves the genome of the current best agent in a file alongside the current configuration
-    void saveBest(bool force = false) const
+    void saveBest(bool force = false)
     {
-        if (((state.iteration % conf::exp::best_save_period) == 0) || force) {
-            pez::core::get<AgentInfo>(0).genome.writeToFile(getCurrentFolder() + "/best_" + toString(state.iteration) + ".bin");
+        if (((state.iteration % conf::exp::best_save_period) != 0) && !force) {
+            return;
+        }
+        auto const& best_genome = pez::core::get<AgentInfo>(0).genome;
+        if constexpr (conf::exp::use_genome_log) {
+            // Genome and configuration are stored in the same record
+            BinaryBufferWriter payload;
+            best_genome.encode(payload.buffer);
+            state.configuration.write(payload);
+            std::vector<char> record;
+            std::string const segment_filename = genome_log.createRecord(state.iteration, payload.buffer, record);
+            async_writer.append(segment_filename, std::move(record));
+        } else {
+            std::vector<char> data;
+            best_genome.encode(data);
+            async_writer.write(getCurrentFolder() + "/best_" + toString(state.iteration) + ".bin", std::move(data));
             // Save configuration
             saveConfiguration(getCurrentFolder() + "/best_conf_" + toString(state.iteration) + ".bin");
         }
     }
 
-    void saveConfiguration(std::string const& filename) const
+    void saveConfiguration(std::string const& filename)
     {
-        BinaryWriter conf_writer{filename};
-        conf_writer.write(state.configuration.max_speed);
-        conf_writer.write(state.configuration.max_accel);
-        conf_writer.write(state.configuration.solver_friction);
-        conf_writer.write(state.configuration.solver_gravity);
-        conf_writer.write(state.configuration.solver_sub_steps);
-        conf_writer.write(state.configuration.solver_compliance);
-        conf_writer.write(state.configuration.task_sub_steps);
+        BinaryBufferWriter writer;
+        state.configuration.write(writer);
+        async_writer.write(filename, std::move(writer.buffer));
     }
 
     [[nodiscard]]
@@ -215,8 +489,15 @@ struct Stadium : public pez::core::IProcessor
         state.newExploration();
         // Change the seed of the RNG
         RNGf::setSeed(state.iteration_exploration + conf::exp::seed_offset);
+        // The last rows of the previous exploration go to its own file
+        telemetry.setFilename(getTelemetryFilename());
         // Create the folder to save genomes
-        std::filesystem::create_directories(getCurrentFolder());
+        async_writer.createDirectories(getCurrentFolder());
+        // Records of a previous run in this folder must not be mixed with the new ones
+        async_writer.flush();
+        genome_log.reset(getCurrentFolder(), true);
+        std::error_code error;
+        std::filesystem::remove(telemetry.getFilename(), error);
         // Base genome is the last exploration best
         auto const best_genome = pez::core::get<AgentInfo>(0).genome;
         pez::core::foreach<AgentInfo>([&best_genome](AgentInfo& a) {
@@ -231,6 +512,12 @@ struct Stadium : public pez::core::IProcessor
         return "genomes_" + toString(state.iteration_exploration);
     }
 
+    [[nodiscard]]
+    std::string getTelemetryFilename() const
+    {
+        return getCurrentFolder() + "/telemetry.bin";
+    }
+
     void increaseDifficulty()
     {
         bypass_score_threshold = false;
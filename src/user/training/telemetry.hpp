@@ -0,0 +1,276 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "engine/common/async_writer.hpp"
+#include "engine/common/binary_io.hpp"
+#include "engine/common/mapped_file.hpp"
+
+
+namespace training
+{
+
+/** Append-only columnar log of the training, one row per generation.
+ *  Each exploration has its own log, stored in its folder next to the genomes.
+ *
+ *  The file is a sequence of blocks, each block holds up to conf::exp::telemetry_block_size rows.
+ *  Block       | magic u32 | version u32 | column count u32 | row count u32 | checksum u64 | columns |
+ *  Columns     | Column 0 values | Column 1 values | ...
+ *  All values are 32 bits little-endian, floats are stored as IEEE-754 binary32.
+ *  Columns are only ever added at the end, readers ignore the ones they don't know.
+ */
+struct Telemetry
+{
+    static constexpr uint32_t block_magic   = 0x424D4C54; // "TLMB"
+    static constexpr uint32_t version       = 1;
+    static constexpr uint64_t header_size   = 24;
+
+    enum Column : uint32_t
+    {
+        Iteration,       // u32
+        BestScore,
+        MeanScore,
+        Score90,         // Score reached by the best 10%
+        Score50,
+        Score10,
+        ConnectionsMean,
+        ConnectionsMax,  // u32
+        NodesMean,
+        Gravity,
+        Friction,
+        SimulationMs,
+        EvolveMs,
+        Count,
+    };
+
+    struct Row
+    {
+        std::array<uint32_t, Column::Count> values{};
+
+        void set(Column column, float value)
+        {
+            std::memcpy(&values[column], &value, sizeof(float));
+        }
+
+        void set(Column column, uint32_t value)
+        {
+            values[column] = value;
+        }
+    };
+};
+
+/// Buffers telemetry rows and appends them to the file by blocks
+class TelemetryWriter
+{
+public:
+    TelemetryWriter(AsyncWriter& writer, std::string filename, uint32_t block_size)
+        : m_writer{writer}
+        , m_filename{std::move(filename)}
+        , m_block_size{block_size}
+    {
+        for (auto& column : m_columns) {
+            column.reserve(m_block_size);
+        }
+    }
+
+    /// Queues the pending rows to the current file, next rows are appended to the new one
+    void setFilename(std::string filename)
+    {
+        flush();
+        m_filename = std::move(filename);
+    }
+
+    [[nodiscard]]
+    std::string const& getFilename() const
+    {
+        return m_filename;
+    }
+
+    void addRow(Telemetry::Row const& row)
+    {
+        for (uint32_t c{0}; c < Telemetry::Column::Count; ++c) {
+            m_columns[c].push_back(row.values[c]);
+        }
+        if (m_columns[0].size() >= m_block_size) {
+            flush();
+        }
+    }
+
+    /// Queues the pending rows, even if the block is not full
+    void flush()
+    {
+        auto const row_count = static_cast<uint32_t>(m_columns[0].size());
+        if (row_count == 0) {
+            return;
+        }
+
+        std::vector<char> block;
+        block.reserve(Telemetry::header_size + Telemetry::Column::Count * row_count * sizeof(uint32_t));
+        le::writeU32(block, Telemetry::block_magic);
+        le::writeU32(block, Telemetry::version);
+        le::writeU32(block, Telemetry::Column::Count);
+        le::writeU32(block, row_count);
+        // Checksum placeholder
+        le::writeU64(block, 0);
+        for (auto& column : m_columns) {
+            for (uint32_t const v : column) {
+                le::writeU32(block, v);
+            }
+            column.clear();
+        }
+        le::storeU64(block.data() + 16, computeChecksum(block.data() + Telemetry::header_size, block.size() - Telemetry::header_size));
+
+        m_writer.append(m_filename, std::move(block));
+    }
+
+private:
+    AsyncWriter& m_writer;
+    std::string  m_filename;
+    uint32_t     m_block_size;
+
+    std::array<std::vector<uint32_t>, Telemetry::Column::Count> m_columns;
+};
+
+/** Memory-mapped access to a telemetry file.
+ *  Only the blocks headers are read when opening the file, values are decoded on access.
+ *  A truncated or corrupted block ends the readable part of the file.
+ */
+class TelemetryReader
+{
+public:
+    explicit
+    TelemetryReader(std::string const& filename)
+        : m_file{filename}
+    {
+        if (!m_file.isValid()) {
+            return;
+        }
+        const char* const data = m_file.getData();
+        uint64_t    const size = m_file.getSize();
+        uint64_t offset = 0;
+        while (size - offset >= Telemetry::header_size) {
+            const char* const header = data + offset;
+            if (le::readU32(header) != Telemetry::block_magic || le::readU32(header + 4) != Telemetry::version) {
+                break;
+            }
+            Block block;
+            block.column_count = le::readU32(header + 8);
+            block.row_count    = le::readU32(header + 12);
+            block.offset       = offset + Telemetry::header_size;
+            block.first_row    = m_row_count;
+            uint64_t const data_size = static_cast<uint64_t>(block.column_count) * block.row_count * sizeof(uint32_t);
+            if (data_size > size - block.offset ||
+                le::readU64(header + 16) != computeChecksum(data + block.offset, data_size)) {
+                break;
+            }
+            m_blocks.push_back(block);
+            m_row_count += block.row_count;
+            offset = block.offset + data_size;
+        }
+    }
+
+    [[nodiscard]]
+    bool isValid() const
+    {
+        return m_file.isValid();
+    }
+
+    [[nodiscard]]
+    uint64_t getRowCount() const
+    {
+        return m_row_count;
+    }
+
+    /// The row has to be lower than the row count
+    [[nodiscard]]
+    uint32_t getU32(uint64_t row, Telemetry::Column column) const
+    {
+        Block const& block = findBlock(row);
+        if (column >= block.column_count) {
+            return 0;
+        }
+        uint64_t const value_offset = block.offset + (static_cast<uint64_t>(column) * block.row_count + (row - block.first_row)) * sizeof(uint32_t);
+        return le::readU32(m_file.getData() + value_offset);
+    }
+
+    [[nodiscard]]
+    float getFloat(uint64_t row, Telemetry::Column column) const
+    {
+        uint32_t const bits = getU32(row, column);
+        float result;
+        std::memcpy(&result, &bits, sizeof(float));
+        return result;
+    }
+
+    /// Calls the callback with each value of the column, in row order
+    template<typename TCallback>
+    void forEachValue(Telemetry::Column column, TCallback&& callback) const
+    {
+        for (Block const& block : m_blocks) {
+            // Blocks written before the column existed are read as zeros
+            if (column >= block.column_count) {
+                for (uint32_t i{0}; i < block.row_count; ++i) {
+                    callback(0u);
+                }
+                continue;
+            }
+            const char* values = m_file.getData() + block.offset + static_cast<uint64_t>(column) * block.row_count * sizeof(uint32_t);
+            for (uint32_t i{0}; i < block.row_count; ++i) {
+                callback(le::readU32(values + i * sizeof(uint32_t)));
+            }
+        }
+    }
+
+    [[nodiscard]]
+    std::vector<uint32_t> readColumnU32(Telemetry::Column column) const
+    {
+        std::vector<uint32_t> result;
+        result.reserve(m_row_count);
+        forEachValue(column, [&](uint32_t value) {
+            result.push_back(value);
+        });
+        return result;
+    }
+
+    [[nodiscard]]
+    std::vector<float> readColumnFloat(Telemetry::Column column) const
+    {
+        std::vector<float> result;
+        result.reserve(m_row_count);
+        forEachValue(column, [&](uint32_t bits) {
+            float value;
+            std::memcpy(&value, &bits, sizeof(float));
+            result.push_back(value);
+        });
+        return result;
+    }
+
+private:
+    struct Block
+    {
+        uint64_t offset       = 0;
+        uint64_t first_row    = 0;
+        uint32_t column_count = 0;
+        uint32_t row_count    = 0;
+    };
+
+    MappedFile         m_file;
+    std::vector<Block> m_blocks;
+    uint64_t           m_row_count = 0;
+
+    [[nodiscard]]
+    Block const& findBlock(uint64_t row) const
+    {
+        // Blocks are sorted by first row
+        auto const it = std::upper_bound(m_blocks.begin(), m_blocks.end(), row, [](uint64_t r, Block const& b) {
+            return r < b.first_row;
+        });
+        return *(it - 1);
+    }
+};
+
+}
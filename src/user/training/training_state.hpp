@@ -16,6 +16,30 @@ struct TrainingState
 
         uint32_t task_sub_steps   = 1;
         uint32_t solver_sub_steps = 8;
+
+        template<typename TWriter>
+        void write(TWriter& writer) const
+        {
+            writer.write(max_speed);
+            writer.write(max_accel);
+            writer.write(solver_friction);
+            writer.write(solver_gravity);
+            writer.write(solver_sub_steps);
+            writer.write(solver_compliance);
+            writer.write(task_sub_steps);
+        }
+
+        template<typename TReader>
+        void read(TReader& reader)
+        {
+            reader.readInto(max_speed);
+            reader.readInto(max_accel);
+            reader.readInto(solver_friction);
+            reader.readInto(solver_gravity);
+            reader.readInto(solver_sub_steps);
+            reader.readInto(solver_compliance);
+            reader.readInto(task_sub_steps);
+        }
     };
 
     uint32_t      iteration             = 0;